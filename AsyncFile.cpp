@@ -0,0 +1,642 @@
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <fcntl.h>
+#include <linux/io_uring.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#include "AsyncFile.hpp"
+
+using namespace JIO;
+
+//Повторы операции после EAGAIN/EINTR, прежде чем она завершится ошибкой
+static constexpr u4 MAX_OP_RETRIES = 16;
+
+struct JIO::AsyncOperation {
+    std::shared_ptr<int> fd;
+    bool write;
+    u8 position;
+    ByteBuffer<false> buffer;
+    CompletionHandler handler;
+    struct iovec iov;
+    //Байт, переданных предыдущими отправками
+    size_t done = 0;
+    u4 retries = 0;
+
+    inline AsyncOperation(const std::shared_ptr<int> &fd, bool write,
+            u8 position, const ByteBuffer<false> &buffer,
+            CompletionHandler handler) :
+    fd(fd), write(write), position(position), buffer(buffer),
+    handler(handler) {
+        iov.iov_base = buffer.getData();
+        iov.iov_len = buffer.capacity();
+    }
+
+    /**
+     * Учитывает результат <code>res</code> очередной отправки. Возвращает
+     * true, если операцию нужно отправить снова: после EAGAIN/EINTR или
+     * частичной записи.
+     */
+    bool resubmit(s4 res) {
+        if (res == -EAGAIN || res == -EINTR) {
+            return ++retries <= MAX_OP_RETRIES;
+        }
+        if (write && res > 0 && size_t(res) < iov.iov_len) {
+            //Запись не должна завершаться частично
+            done += res;
+            iov.iov_base = buffer.getData() + done;
+            iov.iov_len = buffer.capacity() - done;
+            return true;
+        }
+        return false;
+    }
+
+    inline void finish(s4 res) noexcept {
+        if (res < 0) {
+            complete(0, std::make_exception_ptr(IOException(
+                    write ? "Write error: " : "Read error: ",
+                    std::strerror(-res))));
+        } else if (!write && res == 0 && iov.iov_len != 0) {
+            complete(-1, nullptr);
+        } else {
+            complete(done + res, nullptr);
+        }
+    }
+
+    inline void complete(s8 result, std::exception_ptr error) noexcept {
+        try {
+            handler(result, error);
+        } catch (...) {
+            //Исключения обработчика игнорируются
+        }
+    }
+
+    /**
+     * Блокирующее выполнение операции, начиная с <code>done</code> уже
+     * переданных байт. Запись продолжается до полного завершения.
+     */
+    s8 perform(size_t done) {
+        char *data = buffer.getData();
+        size_t length = buffer.capacity();
+        if (!write) {
+            ssize_t n;
+            do {
+                n = ::pread(*fd, data + done, length - done, position + done);
+            } while (n < 0 && errno == EINTR);
+            if (n < 0) {
+                throw IOException("Read error: ", std::strerror(errno));
+            }
+            return (n == 0 && done == 0 && length != 0) ? -1 : done + n;
+        }
+        while (done < length) {
+            ssize_t n = ::pwrite(*fd, data + done, length - done,
+                    position + done);
+            if (n < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                throw IOException("Write error: ", std::strerror(errno));
+            }
+            done += n;
+        }
+        return done;
+    }
+
+    inline void run(size_t done) noexcept {
+        s8 result;
+        try {
+            result = perform(done);
+        } catch (...) {
+            complete(0, std::current_exception());
+            return;
+        }
+        complete(result, nullptr);
+    }
+};
+
+namespace {
+
+    class ThreadPoolService final : public AsyncIOService {
+    public:
+
+        ThreadPoolService(u4 threads) : stopped(false) {
+            for (u4 i = 0; i < threads; i++) {
+                workers.emplace_back(&ThreadPoolService::loop, this);
+            }
+        }
+
+        virtual const char* getName() const noexcept override {
+            return "thread-pool";
+        }
+
+        virtual ~ThreadPoolService() override {
+            {
+                std::lock_guard<std::mutex> guard(lock);
+                stopped = true;
+            }
+            cond.notify_all();
+            for (std::thread &worker : workers) {
+                worker.join();
+            }
+        }
+    protected:
+
+        virtual void submit(std::unique_ptr<AsyncOperation> op) override {
+            {
+                std::lock_guard<std::mutex> guard(lock);
+                queue.push_back(std::move(op));
+            }
+            cond.notify_one();
+        }
+    private:
+        std::mutex lock;
+        std::condition_variable cond;
+        std::deque<std::unique_ptr<AsyncOperation>> queue;
+        std::vector<std::thread> workers;
+        bool stopped;
+
+        void loop() {
+            for (;;) {
+                std::unique_ptr<AsyncOperation> op;
+                {
+                    std::unique_lock<std::mutex> guard(lock);
+                    cond.wait(guard, [this] {
+                        return stopped || !queue.empty();
+                    });
+                    //Перед остановкой очередь обрабатывается до конца
+                    if (queue.empty()) {
+                        return;
+                    }
+                    op = std::move(queue.front());
+                    queue.pop_front();
+                }
+                op->run(0);
+            }
+        }
+    };
+
+    inline int io_uring_setup(u4 entries, struct io_uring_params *p) {
+        return syscall(__NR_io_uring_setup, entries, p);
+    }
+
+    inline int io_uring_enter(int fd, u4 to_submit, u4 min_complete,
+            u4 flags) {
+        return syscall(__NR_io_uring_enter, fd, to_submit, min_complete,
+                flags, nullptr, 0);
+    }
+
+    //Попытки io_uring_enter подряд, прежде чем ошибка считается постоянной
+    constexpr u4 MAX_ENTER_RETRIES = 64;
+
+    void failAll(std::vector<std::unique_ptr<AsyncOperation>> &ops,
+            std::exception_ptr error) noexcept {
+        for (auto &op : ops) {
+            op->complete(0, error);
+        }
+        ops.clear();
+    }
+
+    class IOUringService final : public AsyncIOService {
+    public:
+
+        static std::shared_ptr<AsyncIOService> create(u4 entries) {
+            struct io_uring_params params;
+            std::memset(&params, 0, sizeof (params));
+            int fd = io_uring_setup(entries, &params);
+            if (fd < 0) {
+                return nullptr;
+            }
+            IOUringService *out = new IOUringService(fd, params);
+            if (!out->mapRings()) {
+                delete out;
+                return nullptr;
+            }
+            out->reaper = std::thread(&IOUringService::loop, out);
+            return std::shared_ptr<AsyncIOService>(out);
+        }
+
+        virtual const char* getName() const noexcept override {
+            return "io_uring";
+        }
+
+        virtual ~IOUringService() override {
+            if (reaper.joinable()) {
+                {
+                    std::unique_lock<std::mutex> guard(lock);
+                    stopping = true;
+                    idle.wait(guard, [this] {
+                        return inflight == 0 && pending.empty();
+                    });
+                    //Если кольцо неисправно, поток сам опрашивает очередь
+                    //завершений и замечает остановку
+                    while (!stopped && !wakeReaper()) {
+                        idle.wait_for(guard, std::chrono::milliseconds(1));
+                    }
+                }
+                reaper.join();
+            }
+            if (sqes != nullptr) {
+                munmap(sqes, sqes_size);
+            }
+            if (cq_ptr != nullptr && cq_ptr != sq_ptr) {
+                munmap(cq_ptr, cq_size);
+            }
+            if (sq_ptr != nullptr) {
+                munmap(sq_ptr, sq_size);
+            }
+            ::close(ring_fd);
+        }
+    protected:
+
+        virtual void submit(std::unique_ptr<AsyncOperation> op) override {
+            std::vector<std::unique_ptr<AsyncOperation>> failed;
+            std::exception_ptr error;
+            {
+                std::lock_guard<std::mutex> guard(lock);
+                if (inflight >= params.sq_entries) {
+                    pending.push_back(std::move(op));
+                    return;
+                }
+                push(std::move(op));
+                try {
+                    commitSQEs(1);
+                } catch (...) {
+                    error = std::current_exception();
+                    revokeSQEs(failed);
+                }
+            }
+            if (!failed.empty()) {
+                idle.notify_all();
+                failAll(failed, error);
+            }
+        }
+    private:
+        const int ring_fd;
+        const struct io_uring_params params;
+
+        void *sq_ptr = nullptr;
+        size_t sq_size = 0;
+        void *cq_ptr = nullptr;
+        size_t cq_size = 0;
+        struct io_uring_sqe *sqes = nullptr;
+        size_t sqes_size = 0;
+
+        u4 *sq_head, *sq_tail, *sq_mask, *sq_array;
+        u4 *cq_head, *cq_tail, *cq_mask;
+        struct io_uring_cqe *cqes;
+
+        std::mutex lock;
+        std::condition_variable idle;
+        std::deque<std::unique_ptr<AsyncOperation>> pending;
+        u4 inflight = 0;
+        bool stopping = false;
+        bool stopped = false;
+        std::thread reaper;
+
+        IOUringService(int fd, const struct io_uring_params &p) :
+        ring_fd(fd), params(p) { }
+
+        bool mapRings() {
+            sq_size = params.sq_off.array + params.sq_entries * sizeof (u4);
+            cq_size = params.cq_off.cqes +
+                    params.cq_entries * sizeof (struct io_uring_cqe);
+            bool single = params.features & IORING_FEAT_SINGLE_MMAP;
+            if (single) {
+                sq_size = cq_size = std::max(sq_size, cq_size);
+            }
+
+            void *ptr = mmap(nullptr, sq_size, PROT_READ | PROT_WRITE,
+                    MAP_SHARED | MAP_POPULATE, ring_fd, IORING_OFF_SQ_RING);
+            if (ptr == MAP_FAILED) {
+                return false;
+            }
+            sq_ptr = ptr;
+
+            if (single) {
+                cq_ptr = sq_ptr;
+            } else {
+                ptr = mmap(nullptr, cq_size, PROT_READ | PROT_WRITE,
+                        MAP_SHARED | MAP_POPULATE, ring_fd, IORING_OFF_CQ_RING);
+                if (ptr == MAP_FAILED) {
+                    return false;
+                }
+                cq_ptr = ptr;
+            }
+
+            sqes_size = params.sq_entries * sizeof (struct io_uring_sqe);
+            ptr = mmap(nullptr, sqes_size, PROT_READ | PROT_WRITE,
+                    MAP_SHARED | MAP_POPULATE, ring_fd, IORING_OFF_SQES);
+            if (ptr == MAP_FAILED) {
+                return false;
+            }
+            sqes = reinterpret_cast<struct io_uring_sqe*> (ptr);
+
+            char *sq = reinterpret_cast<char*> (sq_ptr);
+            sq_head = reinterpret_cast<u4*> (sq + params.sq_off.head);
+            sq_tail = reinterpret_cast<u4*> (sq + params.sq_off.tail);
+            sq_mask = reinterpret_cast<u4*> (sq + params.sq_off.ring_mask);
+            sq_array = reinterpret_cast<u4*> (sq + params.sq_off.array);
+
+            char *cq = reinterpret_cast<char*> (cq_ptr);
+            cq_head = reinterpret_cast<u4*> (cq + params.cq_off.head);
+            cq_tail = reinterpret_cast<u4*> (cq + params.cq_off.tail);
+            cq_mask = reinterpret_cast<u4*> (cq + params.cq_off.ring_mask);
+            cqes = reinterpret_cast<struct io_uring_cqe*> (
+                    cq + params.cq_off.cqes);
+            return true;
+        }
+
+        //Вызывается под блокировкой
+        struct io_uring_sqe* nextSQE() {
+            u4 tail = *sq_tail;
+            u4 index = tail & *sq_mask;
+            struct io_uring_sqe *sqe = &sqes[index];
+            std::memset(sqe, 0, sizeof (*sqe));
+            sq_array[index] = index;
+            __atomic_store_n(sq_tail, tail + 1, __ATOMIC_RELEASE);
+            return sqe;
+        }
+
+        //Вызывается под блокировкой
+        void push(std::unique_ptr<AsyncOperation> op) {
+            struct io_uring_sqe *sqe = nextSQE();
+            sqe->opcode = op->write ? IORING_OP_WRITEV : IORING_OP_READV;
+            sqe->fd = *op->fd;
+            sqe->addr = reinterpret_cast<u8> (&op->iov);
+            sqe->len = 1;
+            //Повторная отправка продолжает с первого незаписанного байта
+            sqe->off = op->position + op->done;
+            sqe->user_data = reinterpret_cast<u8> (op.release());
+            inflight++;
+        }
+
+        //Вызывается под блокировкой
+        void commitSQEs(u4 count) {
+            u4 attempts = 0;
+            while (count > 0) {
+                int n = io_uring_enter(ring_fd, count, 0, 0);
+                if (n < 0) {
+                    if ((errno == EINTR || errno == EAGAIN || errno == EBUSY)
+                            && ++attempts < MAX_ENTER_RETRIES) {
+                        sched_yield();
+                        continue;
+                    }
+                    //Ошибка не связана с конкретной операцией
+                    throw IOException("io_uring_enter error: ",
+                            std::strerror(errno));
+                }
+                attempts = 0;
+                count -= std::min<u4>(n, count);
+            }
+        }
+
+        /**
+         * Вызывается под блокировкой: отправляет NOP, чтобы пробудить поток,
+         * ожидающий завершений. Возвращает false, если отправить не удалось.
+         */
+        bool wakeReaper() noexcept {
+            struct io_uring_sqe *sqe = nextSQE();
+            sqe->opcode = IORING_OP_NOP;
+            sqe->user_data = 0;
+            try {
+                commitSQEs(1);
+                return true;
+            } catch (...) {
+                std::vector<std::unique_ptr<AsyncOperation>> none;
+                revokeSQEs(none);
+                return false;
+            }
+        }
+
+        /**
+         * Вызывается под блокировкой после ошибки commitSQEs: забирает
+         * из очереди отправки элементы, ещё не принятые ядром, вместе
+         * с их операциями.
+         */
+        void revokeSQEs(std::vector<std::unique_ptr<AsyncOperation>> &out) {
+            u4 head = __atomic_load_n(sq_head, __ATOMIC_ACQUIRE);
+            u4 tail = *sq_tail;
+            for (u4 i = head; i != tail; i++) {
+                struct io_uring_sqe &sqe = sqes[sq_array[i & *sq_mask]];
+                if (sqe.user_data != 0) {
+                    out.emplace_back(reinterpret_cast<AsyncOperation*>
+                            (sqe.user_data));
+                    inflight--;
+                }
+            }
+            __atomic_store_n(sq_tail, head, __ATOMIC_RELEASE);
+        }
+
+        void loop() {
+            std::vector<std::pair<AsyncOperation*, s4>> done;
+            std::vector<std::unique_ptr<AsyncOperation>> retry, failed;
+            std::exception_ptr error;
+            u4 failures = 0;
+            for (;;) {
+                if (io_uring_enter(ring_fd, 0, 1,
+                        IORING_ENTER_GETEVENTS) < 0 && errno != EINTR) {
+                    if (++failures < MAX_ENTER_RETRIES) {
+                        sched_yield();
+                    } else {
+                        //Начатые операции дозавершаются опросом очереди
+                        //завершений, ожидающие отправки - отменяются
+                        if (failures == MAX_ENTER_RETRIES) {
+                            error = std::make_exception_ptr(IOException(
+                                    "io_uring_enter error: ",
+                                    std::strerror(errno)));
+                            std::lock_guard<std::mutex> guard(lock);
+                            for (auto &op : pending) {
+                                failed.push_back(std::move(op));
+                            }
+                            pending.clear();
+                        }
+                        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                    }
+                } else {
+                    failures = 0;
+                }
+
+                u4 head = *cq_head;
+                u4 tail = __atomic_load_n(cq_tail, __ATOMIC_ACQUIRE);
+                done.clear();
+                for (; head != tail; head++) {
+                    struct io_uring_cqe &cqe = cqes[head & *cq_mask];
+                    if (cqe.user_data != 0) {
+                        done.emplace_back(reinterpret_cast<AsyncOperation*>
+                                (cqe.user_data), cqe.res);
+                    }
+                }
+                __atomic_store_n(cq_head, head, __ATOMIC_RELEASE);
+
+                //Повторы отправляются новыми SQE, а не выполняются здесь
+                size_t completed = done.size();
+                for (auto &entry : done) {
+                    if (entry.first->resubmit(entry.second)) {
+                        retry.emplace_back(entry.first);
+                        entry.first = nullptr;
+                    }
+                }
+
+                bool stop;
+                {
+                    std::lock_guard<std::mutex> guard(lock);
+                    inflight -= completed;
+                    for (auto it = retry.rbegin(); it != retry.rend(); ++it) {
+                        pending.push_front(std::move(*it));
+                    }
+                    retry.clear();
+                    u4 count = 0;
+                    while (!pending.empty() && inflight < params.sq_entries) {
+                        push(std::move(pending.front()));
+                        pending.pop_front();
+                        count++;
+                    }
+                    if (count != 0) {
+                        try {
+                            commitSQEs(count);
+                        } catch (...) {
+                            error = std::current_exception();
+                            revokeSQEs(failed);
+                        }
+                    }
+                    stop = stopping && inflight == 0 && pending.empty();
+                    stopped = stop;
+                }
+                idle.notify_all();
+
+                for (auto &entry : done) {
+                    if (entry.first != nullptr) {
+                        std::unique_ptr<AsyncOperation> op(entry.first);
+                        op->finish(entry.second);
+                    }
+                }
+                failAll(failed, error);
+
+                if (stop) {
+                    return;
+                }
+            }
+        }
+    };
+}
+
+std::shared_ptr<AsyncIOService> AsyncIOService::newIOUring(u4 entries) {
+    if (entries == 0) {
+        throw IllegalArgumentException("entries == 0");
+    }
+    return IOUringService::create(entries);
+}
+
+std::shared_ptr<AsyncIOService> AsyncIOService::newThreadPool(u4 threads) {
+    if (threads == 0) {
+        throw IllegalArgumentException("threads == 0");
+    }
+    return std::make_shared<ThreadPoolService>(threads);
+}
+
+std::shared_ptr<AsyncIOService> AsyncIOService::getDefault() {
+    static std::shared_ptr<AsyncIOService> service = [] {
+        std::shared_ptr<AsyncIOService> out = newIOUring(256);
+        if (out == nullptr) {
+            out = newThreadPool(std::max(4u, std::thread::hardware_concurrency()));
+        }
+        return out;
+    }();
+    return service;
+}
+
+static std::shared_ptr<int> openFile(const File &file, bool writable) {
+    int flags = O_CLOEXEC | (writable ? O_RDWR | O_CREAT : O_RDONLY);
+
+    int fd;
+    do {
+        fd = ::open(file.getPath().c_str(), flags, 0666);
+    } while (fd < 0 && errno == EINTR);
+
+    if (fd < 0) {
+        throw IOException("Unable to open file: ", std::strerror(errno));
+    }
+    return std::shared_ptr<int>(new int(fd), [](int *p) {
+        ::close(*p);
+        delete p;
+    });
+}
+
+AsyncFile::AsyncFile(const File f, bool w,
+        std::shared_ptr<AsyncIOService> s) :
+file(f),
+writable(w),
+fd(),
+service(s) {
+    if (service == nullptr) {
+        throw IllegalArgumentException("service == nullptr");
+    }
+    fd = openFile(file, writable);
+}
+
+void AsyncFile::submit(bool write, u8 position, ByteBuffer<false> buffer,
+        CompletionHandler handler) {
+    if (!handler) {
+        throw IllegalArgumentException("handler is empty");
+    }
+    if (write && !writable) {
+        throw IOException("File is not opened for writing");
+    }
+    service->submit(std::unique_ptr<AsyncOperation>(
+            new AsyncOperation(fd, write, position, buffer, handler)));
+}
+
+void AsyncFile::read(u8 position, ByteBuffer<false> dst,
+        CompletionHandler handler) {
+    if (dst.isReadOnly()) {
+        throw ReadOnlyBufferException();
+    }
+    submit(false, position, dst, handler);
+}
+
+void AsyncFile::write(u8 position, ByteBuffer<false> src,
+        CompletionHandler handler) {
+    submit(true, position, src, handler);
+}
+
+static CompletionHandler toPromise(std::shared_ptr<std::promise<s8>> promise) {
+    return [promise](s8 result, std::exception_ptr error) {
+        if (error) {
+            promise->set_exception(error);
+        } else {
+            promise->set_value(result);
+        }
+    };
+}
+
+std::future<s8> AsyncFile::read(u8 position, ByteBuffer<false> dst) {
+    auto promise = std::make_shared<std::promise<s8>>();
+    std::future<s8> out = promise->get_future();
+    read(position, dst, toPromise(promise));
+    return out;
+}
+
+std::future<s8> AsyncFile::write(u8 position, ByteBuffer<false> src) {
+    auto promise = std::make_shared<std::promise<s8>>();
+    std::future<s8> out = promise->get_future();
+    write(position, src, toPromise(promise));
+    return out;
+}
+
+u8 AsyncFile::size() const {
+    struct stat st;
+    if (fstat(*fd, &st) != 0) {
+        throw IOException("Unable to get file size: ", std::strerror(errno));
+    }
+    return st.st_size;
+}
@@ -0,0 +1,104 @@
+#ifndef ASYNCFILE_HPP
+#define ASYNCFILE_HPP
+
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include "ByteBuffer.hpp"
+#include "File.hpp"
+
+namespace JIO {
+
+    /**
+     * Обработчик завершения асинхронной операции. При успехе
+     * <code>result</code> содержит количество переданных байт (-1 при
+     * чтении за концом файла), а <code>error</code> пуст. При ошибке
+     * <code>error</code> содержит IOException. Вызывается в служебном
+     * потоке, исключения, брошенные обработчиком, игнорируются.
+     */
+    typedef std::function<void(s8 result, std::exception_ptr error)>
+    CompletionHandler;
+
+    struct AsyncOperation;
+
+    /**
+     * Исполнитель асинхронных операций ввода-вывода. Используется io_uring,
+     * если ядро позволяет, иначе пул потоков с блокирующими pread/pwrite.
+     * Деструктор дожидается завершения всех начатых операций, поэтому
+     * последняя ссылка на исполнитель не должна освобождаться
+     * в обработчике завершения.
+     */
+    class AsyncIOService {
+    public:
+        /**
+         * Создаёт исполнитель на основе io_uring с очередью из
+         * <code>entries</code> элементов. Возвращает nullptr, если io_uring
+         * недоступен.
+         */
+        static std::shared_ptr<AsyncIOService> newIOUring(u4 entries);
+
+        static std::shared_ptr<AsyncIOService> newThreadPool(u4 threads);
+
+        /**
+         * Общий исполнитель: io_uring, если доступен, иначе пул потоков.
+         */
+        static std::shared_ptr<AsyncIOService> getDefault();
+
+        virtual const char* getName() const noexcept = 0;
+
+        inline virtual ~AsyncIOService() { }
+    protected:
+        virtual void submit(std::unique_ptr<AsyncOperation> op) = 0;
+
+        friend class AsyncFile;
+    };
+
+    /**
+     * Файл с асинхронным позиционным чтением и записью. Буфер операции
+     * удерживается до её завершения, файл остаётся открытым, пока
+     * не завершатся все начатые операции.
+     */
+    class AsyncFile final {
+    public:
+        AsyncFile(const File file, bool writable,
+                std::shared_ptr<AsyncIOService> service);
+
+        inline AsyncFile(const File file, bool writable) :
+        AsyncFile(file, writable, AsyncIOService::getDefault()) { }
+
+        void read(u8 position, ByteBuffer<false> dst,
+                CompletionHandler handler);
+        std::future<s8> read(u8 position, ByteBuffer<false> dst);
+
+        void write(u8 position, ByteBuffer<false> src,
+                CompletionHandler handler);
+        std::future<s8> write(u8 position, ByteBuffer<false> src);
+
+        u8 size() const;
+
+        inline int getFD() const {
+            return *fd;
+        }
+
+        inline std::shared_ptr<AsyncIOService> getService() const {
+            return service;
+        }
+
+        ~AsyncFile() = default;
+    private:
+        const File file;
+        const bool writable;
+        std::shared_ptr<int> fd;
+        std::shared_ptr<AsyncIOService> service;
+
+        void submit(bool write, u8 position, ByteBuffer<false> buffer,
+                CompletionHandler handler);
+
+        AsyncFile(const AsyncFile&);
+        AsyncFile& operator=(const AsyncFile&);
+    };
+}
+
+#endif /* ASYNCFILE_HPP */
+
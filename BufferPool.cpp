@@ -0,0 +1,263 @@
+#include <cstdlib>
+#include <mutex>
+#include <new>
+#include "BufferPool.hpp"
+#include "exceptions.hpp"
+
+using namespace JIO;
+
+namespace {
+
+    //Место под управляющий блок shared_ptr в каждом блоке пула
+    constexpr size_t BLOCK_HEADER = 64;
+    //Данные блоков выровнены по размеру заголовка
+    static_assert(BLOCK_HEADER == CACHE_LINE_SIZE, "Unexpected header size");
+    constexpr size_t CLASS_COUNT = 13;
+    constexpr size_t SLAB_SIZE = 256 * 1024;
+
+    static_assert((BUFFER_POOL_MIN_SIZE << (CLASS_COUNT - 1))
+            == BUFFER_POOL_MAX_SIZE, "Wrong size classes count");
+
+    constexpr size_t blockSize(size_t cls) {
+        return (BUFFER_POOL_MIN_SIZE << cls) + BLOCK_HEADER;
+    }
+
+    inline size_t classOf(size_t size) {
+        size_t cls = 0;
+        while (cls < CLASS_COUNT && blockSize(cls) < size) {
+            cls++;
+        }
+        return cls;
+    }
+
+    //Количество блоков, передаваемых между общим пулом и кэшем потока
+    constexpr size_t batchSize(size_t cls) {
+        return blockSize(cls) >= SLAB_SIZE / 4 ? 2 : SLAB_SIZE / 4 / blockSize(cls);
+    }
+
+    struct FreeBlock {
+        FreeBlock *next;
+    };
+
+    struct FreeList {
+        FreeBlock *head = nullptr;
+        size_t count = 0;
+
+        inline void push(FreeBlock *block) {
+            block->next = head;
+            head = block;
+            count++;
+        }
+
+        inline FreeBlock* pop() {
+            FreeBlock *out = head;
+            head = out->next;
+            count--;
+            return out;
+        }
+    };
+
+    class GlobalPool {
+    public:
+
+        void refill(size_t cls, FreeList &dst) {
+            std::lock_guard<std::mutex> guard(locks[cls]);
+            FreeList &src = lists[cls];
+            if (src.count == 0) {
+                newSlab(cls, src);
+            }
+            for (size_t n = batchSize(cls); n > 0 && src.count > 0; n--) {
+                dst.push(src.pop());
+            }
+        }
+
+        void release(size_t cls, FreeList &src, size_t count) {
+            std::lock_guard<std::mutex> guard(locks[cls]);
+            FreeList &dst = lists[cls];
+            for (; count > 0 && src.count > 0; count--) {
+                dst.push(src.pop());
+            }
+        }
+    private:
+        std::mutex locks[CLASS_COUNT];
+        FreeList lists[CLASS_COUNT];
+
+        void newSlab(size_t cls, FreeList &dst) {
+            size_t size = blockSize(cls);
+            size_t count = SLAB_SIZE / size;
+            if (count < 2) {
+                count = 2;
+            }
+            void *slab = std::aligned_alloc(BLOCK_HEADER, size * count);
+            if (slab == nullptr) {
+                throw std::bad_alloc();
+            }
+            char *data = reinterpret_cast<char*> (slab);
+            for (size_t i = 0; i < count; i++) {
+                dst.push(reinterpret_cast<FreeBlock*> (data + i * size));
+            }
+        }
+    };
+
+    //Общий пул не разрушается, чтобы буферы можно было освобождать
+    //в деструкторах статических объектов
+    GlobalPool& globalPool() {
+        static GlobalPool *pool = new GlobalPool();
+        return *pool;
+    }
+
+    struct ThreadCache {
+        FreeList lists[CLASS_COUNT];
+    };
+
+    thread_local ThreadCache *thread_cache = nullptr;
+
+    struct ThreadCacheOwner {
+        ThreadCache cache;
+
+        inline ThreadCacheOwner() {
+            thread_cache = &cache;
+        }
+
+        ~ThreadCacheOwner() {
+            thread_cache = nullptr;
+            for (size_t cls = 0; cls < CLASS_COUNT; cls++) {
+                FreeList &list = cache.lists[cls];
+                globalPool().release(cls, list, list.count);
+            }
+        }
+    };
+
+    thread_local ThreadCacheOwner thread_cache_owner;
+
+    inline ThreadCache* currentCache() {
+        ThreadCache *out = thread_cache;
+        if (out == nullptr) {
+            //Первое обращение создаёт кэш потока, после его разрушения
+            //используется только общий пул
+            static thread_local bool created = false;
+            if (!created) {
+                created = true;
+                out = &thread_cache_owner.cache;
+            }
+        }
+        return out;
+    }
+
+    void* allocateBlock(size_t cls) {
+        ThreadCache *cache = currentCache();
+        if (cache == nullptr) {
+            FreeList tmp;
+            globalPool().refill(cls, tmp);
+            FreeBlock *out = tmp.pop();
+            globalPool().release(cls, tmp, tmp.count);
+            return out;
+        }
+        FreeList &list = cache->lists[cls];
+        if (list.count == 0) {
+            globalPool().refill(cls, list);
+        }
+        return list.pop();
+    }
+
+    void releaseBlock(size_t cls, void *ptr) {
+        FreeBlock *block = reinterpret_cast<FreeBlock*> (ptr);
+        ThreadCache *cache = currentCache();
+        if (cache == nullptr) {
+            FreeList tmp;
+            tmp.push(block);
+            globalPool().release(cls, tmp, 1);
+            return;
+        }
+        FreeList &list = cache->lists[cls];
+        list.push(block);
+        if (list.count >= 2 * batchSize(cls)) {
+            globalPool().release(cls, list, batchSize(cls));
+        }
+    }
+
+    /**
+     * Размещает управляющий блок shared_ptr в заголовке блока пула,
+     * освобождение управляющего блока возвращает в пул весь блок.
+     */
+    template<typename T>
+    struct HeaderAllocator {
+        typedef T value_type;
+
+        void *block;
+        size_t cls;
+
+        inline HeaderAllocator(void *block, size_t cls) :
+        block(block), cls(cls) { }
+
+        template<typename U>
+        inline HeaderAllocator(const HeaderAllocator<U> &other) :
+        block(other.block), cls(other.cls) { }
+
+        inline T* allocate(size_t n) {
+            static_assert(alignof (T) <= BLOCK_HEADER, "Too big alignment");
+            if (n * sizeof (T) > BLOCK_HEADER) {
+                throw std::bad_alloc();
+            }
+            return reinterpret_cast<T*> (block);
+        }
+
+        inline void deallocate(T*, size_t) {
+            releaseBlock(cls, block);
+        }
+
+        template<typename U>
+        inline bool operator==(const HeaderAllocator<U> &other) const {
+            return block == other.block;
+        }
+
+        template<typename U>
+        inline bool operator!=(const HeaderAllocator<U> &other) const {
+            return block != other.block;
+        }
+    };
+
+    //Память освобождается вместе с управляющим блоком
+    inline void keep(char*) { }
+}
+
+std::shared_ptr<char> JIO::allocateBuffer(size_t capacity) {
+    if (capacity > BUFFER_POOL_MAX_SIZE) {
+        char *data = reinterpret_cast<char*> (std::malloc(capacity));
+        if (data == nullptr) {
+            throw std::bad_alloc();
+        }
+        return std::shared_ptr<char>(data, std::free);
+    }
+    size_t cls = classOf(capacity + BLOCK_HEADER);
+    void *block = allocateBlock(cls);
+    char *data = reinterpret_cast<char*> (block) + BLOCK_HEADER;
+    try {
+        return std::shared_ptr<char>(data, keep,
+                HeaderAllocator<char>(block, cls));
+    } catch (...) {
+        releaseBlock(cls, block);
+        throw;
+    }
+}
+
+void* JIO::allocateAligned(size_t capacity, size_t alignment) {
+    if (alignment < sizeof (void*) || (alignment & (alignment - 1)) != 0) {
+        throw IllegalArgumentException("Illegal alignment: ", alignment);
+    }
+    void *out;
+    if (posix_memalign(&out, alignment, capacity == 0 ? 1 : capacity) != 0) {
+        throw std::bad_alloc();
+    }
+    return out;
+}
+
+std::shared_ptr<char> JIO::allocateAlignedBuffer(size_t capacity,
+        size_t alignment) {
+    if (alignment <= CACHE_LINE_SIZE && (alignment & (alignment - 1)) == 0
+            && capacity <= BUFFER_POOL_MAX_SIZE) {
+        return allocateBuffer(capacity);
+    }
+    char *data = reinterpret_cast<char*> (allocateAligned(capacity, alignment));
+    return std::shared_ptr<char>(data, std::free);
+}
@@ -0,0 +1,47 @@
+#ifndef BUFFERPOOL_HPP
+#define BUFFERPOOL_HPP
+
+#include <cstddef>
+#include <memory>
+
+namespace JIO {
+
+    constexpr const size_t BUFFER_POOL_MIN_SIZE = 256;
+    constexpr const size_t BUFFER_POOL_MAX_SIZE = 1024 * 1024;
+
+    /**
+     * Выделяет память для буфера размера <code>capacity</code>. Размеры до
+     * BUFFER_POOL_MAX_SIZE округляются вверх до степени двойки и берутся из
+     * пула: данные и счётчик ссылок располагаются в одном блоке, блоки
+     * кэшируются в потоке и возвращаются в пул при освобождении последней
+     * ссылки. Память пула не возвращается системе. Большие размеры
+     * выделяются через malloc.
+     */
+    std::shared_ptr<char> allocateBuffer(size_t capacity);
+
+    constexpr const size_t CACHE_LINE_SIZE = 64;
+
+    /**
+     * Выравнивание адреса, размера и смещения в файле для ввода-вывода
+     * в обход кэша страниц (O_DIRECT).
+     */
+    constexpr const size_t DIRECT_IO_ALIGNMENT = 4096;
+
+    /**
+     * Выделяет через posix_memalign память размера <code>capacity</code>,
+     * выровненную по <code>alignment</code> (степень двойки). Память
+     * освобождается через free.
+     */
+    void* allocateAligned(size_t capacity, size_t alignment);
+
+    /**
+     * То же, что <code>allocateBuffer</code>, но начало данных выровнено
+     * по <code>alignment</code>. Блоки пула выровнены по CACHE_LINE_SIZE,
+     * поэтому пул используется только при таком или меньшем выравнивании.
+     */
+    std::shared_ptr<char> allocateAlignedBuffer(size_t capacity,
+            size_t alignment);
+}
+
+#endif /* BUFFERPOOL_HPP */
+
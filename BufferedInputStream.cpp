@@ -0,0 +1,149 @@
+#include "BufferedStreams.hpp"
+#include "ByteSearch.hpp"
+
+using namespace JIO;
+
+BufferedInputStream::BufferedInputStream(InputStream &input, s8 bufsize) :
+in(input),
+size(bufsize),
+buf(),
+position(0),
+count(0) {
+    if (bufsize <= 0) {
+        throw IllegalArgumentException("Buffer size <= 0");
+    }
+    buf.reset(new u1[bufsize]);
+}
+
+s8 BufferedInputStream::fill() {
+    position = 0;
+    count = 0;
+    s8 n = in.read(buf.get(), 0, size);
+    if (n > 0) {
+        count = n;
+    }
+    return n;
+}
+
+int BufferedInputStream::readSlow() {
+    s8 n;
+    do {
+        n = fill();
+        if (n < 0) {
+            return -1;
+        }
+    } while (n == 0);
+    return buf[position++];
+}
+
+s8 BufferedInputStream::readSlow(u1 *data, s8 length) {
+    s8 n = 0;
+    for (;;) {
+        s8 avail = count - position;
+        if (avail > 0) {
+            s8 cnt = std::min(avail, length - n);
+            std::memcpy(data + n, buf.get() + position, cnt);
+            position += cnt;
+            n += cnt;
+        } else if (length - n >= size) {
+            //Большие запросы читаются в обход буфера
+            s8 nr = in.read(data, n, length - n);
+            if (nr < 0) {
+                return n == 0 ? -1 : n;
+            }
+            n += nr;
+        } else {
+            s8 nr = fill();
+            if (nr < 0) {
+                return n == 0 ? -1 : n;
+            }
+            if (nr == 0) {
+                return n;
+            }
+            continue;
+        }
+        if (n >= length || in.available() <= 0) {
+            return n;
+        }
+    }
+}
+
+const u1* BufferedInputStream::peekSlow(s8 length) {
+    checkLength(length);
+    if (length > size) {
+        return nullptr;
+    }
+    s8 avail = count - position;
+    if (position != 0) {
+        std::memmove(buf.get(), buf.get() + position, avail);
+        position = 0;
+        count = avail;
+    }
+    while (count < length) {
+        s8 nr = in.read(buf.get(), count, size - count);
+        //Как и в readSlow, пустое чтение прекращает попытки
+        if (nr <= 0) {
+            return nullptr;
+        }
+        count += nr;
+    }
+    return buf.get();
+}
+
+s8 BufferedInputStream::readUntil(u1 delimiter, OutputStream &out) {
+    s8 total = 0;
+    bool started = false;
+    for (;;) {
+        s8 avail = count - position;
+        if (avail > 0) {
+            started = true;
+            const u1 *data = buf.get() + position;
+            s8 index = indexOfByte(data, avail, delimiter);
+            if (index >= 0) {
+                out.write(data, 0, index);
+                position += index + 1;
+                return total + index;
+            }
+            out.write(data, 0, avail);
+            position = count;
+            total += avail;
+        }
+        if (fill() < 0) {
+            return started ? total : -1;
+        }
+    }
+}
+
+s8 BufferedInputStream::skip(s8 n) {
+    if (n <= 0) {
+        return 0;
+    }
+    s8 avail = count - position;
+    if (avail >= n) {
+        position += n;
+        return n;
+    }
+    position = count;
+    s8 skipped = in.skip(n - avail);
+    return avail + (skipped < 0 ? 0 : skipped);
+}
+
+s8 BufferedInputStream::available() {
+    s8 avail = count - position;
+    s8 other = in.available();
+    //Защита от переполнения
+    return avail > INT64_MAX - other ? INT64_MAX : avail + other;
+}
+
+s8 BufferedInputStream::transferTo(OutputStream &out, s8 max) {
+    if (max < 0) {
+        throw IllegalArgumentException("max < 0");
+    }
+
+    s8 avail = std::min(count - position, max);
+    if (avail > 0) {
+        out.write(buf.get(), position, avail);
+        position += avail;
+    }
+    return avail + in.transferTo(out, max - avail);
+}
@@ -0,0 +1,68 @@
+#include "BufferedStreams.hpp"
+
+using namespace JIO;
+
+BufferedOutputStream::BufferedOutputStream(OutputStream &output, s8 bufsize) :
+out(output),
+size(bufsize),
+buf(),
+count(0) {
+    if (bufsize <= 0) {
+        throw IllegalArgumentException("Buffer size <= 0");
+    }
+    buf.reset(new u1[bufsize]);
+}
+
+void BufferedOutputStream::flushBuffer() {
+    if (count > 0) {
+        out.write(buf.get(), 0, count);
+        count = 0;
+    }
+}
+
+void BufferedOutputStream::writeSlow(const u1 *data, s8 length) {
+    flushBuffer();
+    if (length >= size) {
+        //Большие запросы записываются в обход буфера
+        out.write(data, 0, length);
+        return;
+    }
+    std::memcpy(buf.get(), data, length);
+    count = length;
+}
+
+void BufferedOutputStream::writev(const WriteSegment *segments, s8 n) {
+    checkSegments(segments, n);
+
+    s8 total = 0;
+    for (s8 i = 0; i < n; i++) {
+        checkSBounds(segments[i].data, 0, segments[i].length);
+        total += segments[i].length;
+    }
+
+    if (total > size - count) {
+        flushBuffer();
+        if (total >= size) {
+            //Большие запросы записываются в обход буфера
+            out.writev(segments, n);
+            return;
+        }
+    }
+    for (s8 i = 0; i < n; i++) {
+        std::memcpy(buf.get() + count, segments[i].data, segments[i].length);
+        count += segments[i].length;
+    }
+}
+
+void BufferedOutputStream::flush() {
+    flushBuffer();
+    out.flush();
+}
+
+BufferedOutputStream::~BufferedOutputStream() {
+    try {
+        flushBuffer();
+    } catch (...) {
+        //Деструктор не должен бросать исключения
+    }
+}
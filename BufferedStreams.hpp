@@ -0,0 +1,155 @@
+#ifndef BUFFEREDSTREAMS_HPP
+#define BUFFEREDSTREAMS_HPP
+
+#include <cstring>
+#include <memory>
+#include "Streams.hpp"
+
+namespace JIO {
+
+    constexpr const s8 DEFAULT_BUFFER_SIZE = 8192;
+
+    /**
+     * Буферизирующая обёртка над <code>InputStream</code>. Однобайтовое
+     * чтение и чтение небольших блоков обслуживаются из внутреннего буфера
+     * без виртуальных вызовов исходного потока, запросы не меньше размера
+     * буфера передаются исходному потоку напрямую.
+     */
+    class BufferedInputStream final : public InputStream {
+    public:
+        BufferedInputStream(InputStream &in, s8 size);
+
+        inline BufferedInputStream(InputStream &in) :
+        BufferedInputStream(in, DEFAULT_BUFFER_SIZE) { }
+
+        using InputStream::read;
+        using InputStream::transferTo;
+        using InputStream::borrow;
+
+        inline virtual int read() override {
+            if (position < count) {
+                return buf[position++];
+            }
+            return readSlow();
+        }
+
+        inline virtual s8 read(void *b, s8 offset, s8 length) override {
+            u1 *data = checkSBounds<u1*>(b, offset, length);
+            if (length <= count - position) {
+                std::memcpy(data, buf.get() + position, length);
+                position += length;
+                return length;
+            }
+            return readSlow(data, length);
+        }
+
+        virtual s8 skip(s8 count) override;
+        virtual s8 available() override;
+        virtual s8 transferTo(OutputStream &out, s8 max) override;
+
+        /**
+         * Если данных в буфере не хватает, а <code>length</code> не больше
+         * размера буфера, остаток сдвигается в начало и буфер дополняется
+         * из исходного потока.
+         */
+        inline virtual const u1* peek(s8 length) override {
+            if (u8(length) <= u8(count - position)) {
+                return buf.get() + position;
+            }
+            return peekSlow(length);
+        }
+
+        inline virtual const u1* borrow(s8 length) override {
+            const u1 *out = peek(length);
+            if (out != nullptr) {
+                position += length;
+            }
+            return out;
+        }
+
+        /**
+         * Передаёт в <code>out</code> байты до разделителя
+         * <code>delimiter</code>. Разделитель считывается, но не передаётся.
+         * Возвращается количество переданных байт или -1, если конец данных
+         * достигнут до начала чтения.
+         */
+        s8 readUntil(u1 delimiter, OutputStream &out);
+
+        inline s8 bufferSize() const {
+            return size;
+        }
+
+        inline virtual ~BufferedInputStream() override { }
+    private:
+        InputStream &in;
+        const s8 size;
+        std::unique_ptr<u1[]> buf;
+        s8 position;
+        s8 count;
+
+        s8 fill();
+        int readSlow();
+        s8 readSlow(u1 *data, s8 length);
+        const u1* peekSlow(s8 length);
+
+        BufferedInputStream(const BufferedInputStream&);
+        BufferedInputStream& operator=(const BufferedInputStream&);
+    };
+
+    /**
+     * Буферизирующая обёртка над <code>OutputStream</code>. Данные
+     * накапливаются во внутреннем буфере и передаются исходному потоку
+     * при его заполнении, при вызове <code>flush()</code> и в деструкторе.
+     * Запросы не меньше размера буфера передаются исходному потоку напрямую.
+     */
+    class BufferedOutputStream final : public OutputStream {
+    public:
+        BufferedOutputStream(OutputStream &out, s8 size);
+
+        inline BufferedOutputStream(OutputStream &out) :
+        BufferedOutputStream(out, DEFAULT_BUFFER_SIZE) { }
+
+        using OutputStream::write;
+        using OutputStream::writev;
+
+        inline virtual void write(u1 byte) override {
+            if (count >= size) {
+                flushBuffer();
+            }
+            buf[count++] = byte;
+        }
+
+        inline virtual void write(const void *b, s8 offset, s8 length) override {
+            const u1 *data = checkSBounds<const u1*>(b, offset, length);
+            if (length <= size - count) {
+                std::memcpy(buf.get() + count, data, length);
+                count += length;
+                return;
+            }
+            writeSlow(data, length);
+        }
+
+        virtual void writev(const WriteSegment *segments, s8 count) override;
+        virtual void flush() override;
+
+        inline s8 bufferSize() const {
+            return size;
+        }
+
+        virtual ~BufferedOutputStream() override;
+    private:
+        OutputStream &out;
+        const s8 size;
+        std::unique_ptr<u1[]> buf;
+        s8 count;
+
+        void flushBuffer();
+        void writeSlow(const u1 *data, s8 length);
+
+        BufferedOutputStream(const BufferedOutputStream&);
+        BufferedOutputStream& operator=(const BufferedOutputStream&);
+    };
+}
+
+#endif /* BUFFEREDSTREAMS_HPP */
+
@@ -3,8 +3,14 @@
 
 #include <cstring>
 #include <memory>
+#include <type_traits>
+#include "BufferPool.hpp"
+#include "ByteOrder.hpp"
+#include "ByteSearch.hpp"
+#include "Checksum.hpp"
 #include "checks.hpp"
 #include "exceptions.hpp"
+#include "Varint.hpp"
 
 namespace JIO {
 
@@ -17,17 +23,155 @@ namespace JIO {
 
     inline void null_deleter(void*) { }
 
+    /**
+     * Участок буфера длины <code>length</code> от текущей позиции, границы
+     * которого проверяются один раз при создании. Чтение и запись внутри
+     * участка не проверяются: выход за его пределы приводит
+     * к неопределённому поведению. Участок буфера только для чтения
+     * не создаётся. Позиция буфера сдвигается только при вызове
+     * <code>commit()</code>.
+     */
+    class ByteBufferRegion {
+    private:
+        char *ptr;
+        char *const begin;
+        char *const end;
+        size_t &position;
+        const size_t base;
+
+        static inline char* checkedStart(char *data, size_t position,
+                size_t capacity, size_t length) {
+            checkRange(position, length, capacity);
+            return data + position;
+        }
+    public:
+
+        inline ByteBufferRegion(char *data, size_t &position,
+                size_t capacity, size_t length) :
+        ptr(checkedStart(data, position, capacity, length)),
+        begin(ptr), end(ptr + length),
+        position(position), base(position) { }
+
+        inline size_t remaining() const {
+            return end - ptr;
+        }
+
+        inline size_t offset() const {
+            return ptr - begin;
+        }
+
+        inline void get(void *dst, size_t length) {
+            std::memcpy(dst, ptr, length);
+            ptr += length;
+        }
+
+        inline void put(const void *src, size_t length) {
+            std::memcpy(ptr, src, length);
+            ptr += length;
+        }
+
+        inline void skip(size_t length) {
+            ptr += length;
+        }
+
+        template<typename T>
+        inline void getObject(T &obj) {
+            get(&obj, sizeof (T));
+        }
+
+        template<typename T>
+        inline T getObject() {
+            T out;
+            get(&out, sizeof (T));
+            return out;
+        }
+
+        template<typename T>
+        inline void putObject(const T &obj) {
+            put(&obj, sizeof (T));
+        }
+
+        template<ByteOrder order, typename T>
+        inline void getObject(T &obj) {
+            getObject(obj);
+            obj = convertOrder<order>(obj);
+        }
+
+        template<ByteOrder order, typename T>
+        inline T getObject() {
+            return convertOrder<order>(getObject<T>());
+        }
+
+        template<ByteOrder order, typename T>
+        inline void putObject(T obj) {
+            putObject(convertOrder<order>(obj));
+        }
+
+        template<typename T>
+        inline void getObjects(T *dst, size_t count) {
+            static_assert(std::is_trivially_copyable<T>::value,
+                    "T must be trivially copyable");
+            get(dst, count * sizeof (T));
+        }
+
+        template<typename T>
+        inline void putObjects(const T *src, size_t count) {
+            static_assert(std::is_trivially_copyable<T>::value,
+                    "T must be trivially copyable");
+            put(src, count * sizeof (T));
+        }
+
+        template<ByteOrder order, typename T>
+        inline void getObjects(T *dst, size_t count) {
+            getObjects(dst, count);
+            convertOrder<order>(dst, dst, count);
+        }
+
+        template<ByteOrder order, typename T>
+        inline void putObjects(const T *src, size_t count) {
+            convertOrderUnaligned<order, T>(ptr, src, count);
+            ptr += count * sizeof (T);
+        }
+
+        template<typename T>
+        ByteBufferRegion& operator<<(const T &obj) {
+            putObject(obj);
+            return *this;
+        }
+
+        template<typename T>
+        ByteBufferRegion& operator>>(T &obj) {
+            getObject(obj);
+            return *this;
+        }
+
+        /**
+         * Сдвигает позицию буфера за последний прочитанный или записанный
+         * байт участка.
+         */
+        inline void commit() {
+            position = base + offset();
+        }
+    };
+
     template<>
     class ByteBuffer<false> {
     private:
         size_t start;
         size_t _capacity;
         std::shared_ptr<char> ptr_data;
+        bool readOnly = false;
+
+        inline void checkWritable() const {
+            if (readOnly) {
+                throw ReadOnlyBufferException();
+            }
+        }
+    public:
 
         inline ByteBuffer(const std::shared_ptr<char> &ptr, size_t start,
                 size_t capacity) :
         start(start), _capacity(capacity), ptr_data(ptr) { }
-    public:
 
         inline ByteBuffer(void *ptr, size_t start, size_t capacity, bool clean) :
         start(0), _capacity(capacity),
@@ -38,18 +182,44 @@ namespace JIO {
         ByteBuffer(ptr, start, capacity, true) { }
 
         inline ByteBuffer(size_t capacity) :
-        ByteBuffer(new char[capacity], 0, capacity) { }
+        start(0), _capacity(capacity), ptr_data(allocateBuffer(capacity)) { }
+
+        /**
+         * Создаёт буфер, начало которого выровнено по <code>alignment</code>,
+         * например по CACHE_LINE_SIZE или DIRECT_IO_ALIGNMENT.
+         */
+        static inline ByteBuffer allocateAligned(size_t capacity,
+                size_t alignment) {
+            return ByteBuffer(allocateAlignedBuffer(capacity, alignment),
+                    0, capacity);
+        }
 
-        inline void set(ByteBuffer other) {
+        inline void set(const ByteBuffer &other) {
             ptr_data = other.ptr_data;
             _capacity = other._capacity;
             start = other.start;
+            readOnly = other.readOnly;
         }
 
         inline size_t capacity() const {
             return _capacity;
         }
 
+        /**
+         * Запись в буфер только для чтения, его срезы и курсоры бросает
+         * ReadOnlyBufferException. Память, полученная через
+         * <code>getData()</code>, при этом изменять нельзя.
+         */
+        inline bool isReadOnly() const {
+            return readOnly;
+        }
+
+        inline ByteBuffer asReadOnly() const {
+            ByteBuffer out(*this);
+            out.readOnly = true;
+            return out;
+        }
+
         inline char* getBase() const {
             return ptr_data.get();
         }
@@ -64,20 +234,23 @@ namespace JIO {
         }
 
         inline void put(size_t index, const void *src, size_t length) {
+            checkWritable();
             checkRange(index, length, _capacity);
             std::memmove(getData() + index, src, length);
         }
 
-        inline void get(size_t index, ByteBuffer dst,
+        inline void get(size_t index, const ByteBuffer &dst,
                 size_t offset, size_t length) const {
+            dst.checkWritable();
             checkRange(index, length, _capacity);
             checkRange(offset, length, dst._capacity);
             std::memmove(dst.getData() + offset,
                     getData() + index, length);
         }
 
-        inline void put(size_t index, const ByteBuffer src,
+        inline void put(size_t index, const ByteBuffer &src,
                 size_t offset, size_t length) {
+            checkWritable();
             checkRange(index, length, _capacity);
             checkRange(offset, length, src._capacity);
             std::memmove(getData() + index,
@@ -94,7 +267,109 @@ namespace JIO {
             put(index, &obj, sizeof (T));
         }
 
+        /**
+         * Чтение и запись числа в порядке байт <code>order</code>.
+         */
+        template<ByteOrder order, typename T>
+        inline void getObject(size_t index, T &obj) const {
+            getObject(index, obj);
+            obj = convertOrder<order>(obj);
+        }
+
+        template<ByteOrder order, typename T>
+        inline T getObject(size_t index) const {
+            T out;
+            getObject<order>(index, out);
+            return out;
+        }
+
+        template<ByteOrder order, typename T>
+        inline void putObject(size_t index, T obj) {
+            putObject(index, convertOrder<order>(obj));
+        }
+
+        /**
+         * Чтение и запись <code>count</code> тривиально копируемых объектов
+         * с одной проверкой границ и одним копированием. Версии с порядком
+         * байт допускают только числа и перечисления и меняют порядок байт
+         * сразу во всём массиве.
+         */
+        template<typename T>
+        inline void getObjects(size_t index, T *dst, size_t count) const {
+            static_assert(std::is_trivially_copyable<T>::value,
+                    "T must be trivially copyable");
+            get(index, dst, checkArrayLength(count, sizeof (T)));
+        }
+
+        template<typename T>
+        inline void putObjects(size_t index, const T *src, size_t count) {
+            static_assert(std::is_trivially_copyable<T>::value,
+                    "T must be trivially copyable");
+            put(index, src, checkArrayLength(count, sizeof (T)));
+        }
+
+        template<ByteOrder order, typename T>
+        inline void getObjects(size_t index, T *dst, size_t count) const {
+            getObjects(index, dst, count);
+            convertOrder<order>(dst, dst, count);
+        }
+
+        template<ByteOrder order, typename T>
+        inline void putObjects(size_t index, const T *src, size_t count) {
+            checkWritable();
+            checkRange(index, checkArrayLength(count, sizeof (T)), _capacity);
+            convertOrderUnaligned<order, T>(getData() + index, src, count);
+        }
+
+        /**
+         * Индекс первого байта <code>value</code>, начиная с
+         * <code>fromIndex</code>, или -1.
+         */
+        inline s8 indexOf(u1 value, size_t fromIndex = 0) const {
+            if (fromIndex >= _capacity) {
+                return -1;
+            }
+            s8 out = indexOfByte(getData() + fromIndex,
+                    _capacity - fromIndex, value);
+            return out < 0 ? -1 : out + fromIndex;
+        }
+
+        inline s8 indexOf(const void *pattern, size_t length,
+                size_t fromIndex = 0) const {
+            if (fromIndex > _capacity) {
+                return -1;
+            }
+            s8 out = indexOfBytes(getData() + fromIndex,
+                    _capacity - fromIndex, pattern, length);
+            return out < 0 ? -1 : out + fromIndex;
+        }
+
+        inline s8 lastIndexOf(u1 value) const {
+            return lastIndexOfByte(getData(), _capacity, value);
+        }
+
+        inline size_t count(u1 value) const {
+            return countByte(getData(), _capacity, value);
+        }
+
+        inline u4 crc32c() const {
+            return JIO::crc32c(0, getData(), _capacity);
+        }
+
+        inline u4 crc32() const {
+            return JIO::crc32(0, getData(), _capacity);
+        }
+
+        inline u8 xxHash64(u8 seed = 0) const {
+            return JIO::xxHash64(getData(), _capacity, seed);
+        }
+
+        inline void updateChecksum(Checksum &checksum) const {
+            checksum.update(getData(), _capacity);
+        }
+
         inline void copy(size_t fromIndex, size_t toIndex, size_t length) {
+            checkWritable();
             checkRange(fromIndex, length, _capacity);
             checkRange(toIndex, length, _capacity);
             char *data = getData();
@@ -103,12 +378,16 @@ namespace JIO {
 
         inline const ByteBuffer slice(size_t index, size_t length) const {
             checkRange(index, length, _capacity);
-            return ByteBuffer(ptr_data, start + index, length);
+            ByteBuffer out(ptr_data, start + index, length);
+            out.readOnly = readOnly;
+            return out;
         }
 
         inline ByteBuffer slice(size_t index, size_t length) {
             checkRange(index, length, _capacity);
-            return ByteBuffer(ptr_data, start + index, length);
+            ByteBuffer out(ptr_data, start + index, length);
+            out.readOnly = readOnly;
+            return out;
         }
 
         inline ByteBuffer clone(size_t index, size_t length) const {
@@ -132,11 +411,11 @@ namespace JIO {
     class ByteBuffer <true> : public ByteBuffer<false> {
     private:
         mutable size_t _position;
+    public:
 
         inline ByteBuffer(const std::shared_ptr<char> &ptr, size_t start,
                 size_t capacity) :
         ByteBuffer<false>(ptr, start, capacity), _position(0) { }
-    public:
 
         inline ByteBuffer(void *ptr, size_t start, size_t capacity, bool clean) :
         ByteBuffer<false>(ptr, start, capacity, clean), _position(0) { }
@@ -147,17 +426,32 @@ namespace JIO {
         inline ByteBuffer(size_t capacity) : ByteBuffer<false>(capacity),
         _position(0) { }
 
-        inline void set(ByteBuffer<true> other) {
+        static inline ByteBuffer<true> allocateAligned(size_t capacity,
+                size_t alignment) {
+            return ByteBuffer<true>(allocateAlignedBuffer(capacity, alignment),
+                    0, capacity);
+        }
+
+        inline void set(const ByteBuffer<true> &other) {
             ptr_data = other.ptr_data;
             _capacity = other._capacity;
             start = other.start;
+            readOnly = other.readOnly;
             _position = other._position;
         }
 
+        inline ByteBuffer<true> asReadOnly() const {
+            ByteBuffer<true> out(*this);
+            out.readOnly = true;
+            return out;
+        }
+
         using ByteBuffer<false>::get;
         using ByteBuffer<false>::put;
         using ByteBuffer<false>::getObject;
         using ByteBuffer<false>::putObject;
+        using ByteBuffer<false>::getObjects;
+        using ByteBuffer<false>::putObjects;
 
         inline void get(void *dst, size_t length) const {
             size_t tmp = _position;
@@ -181,14 +475,109 @@ namespace JIO {
             put(&obj, sizeof (T));
         }
 
+        template<ByteOrder order, typename T>
+        inline void getObject(T &obj) const {
+            getObject(obj);
+            obj = convertOrder<order>(obj);
+        }
+
+        template<ByteOrder order, typename T>
+        inline T getObject() const {
+            T out;
+            getObject<order>(out);
+            return out;
+        }
+
+        template<ByteOrder order, typename T>
+        inline void putObject(T obj) {
+            putObject(convertOrder<order>(obj));
+        }
+
+        template<typename T>
+        inline void getObjects(T *dst, size_t count) const {
+            size_t tmp = _position;
+            getObjects(tmp, dst, count);
+            _position = tmp + count * sizeof (T);
+        }
+
+        template<typename T>
+        inline void putObjects(const T *src, size_t count) {
+            size_t tmp = _position;
+            putObjects(tmp, src, count);
+            _position = tmp + count * sizeof (T);
+        }
+
+        template<ByteOrder order, typename T>
+        inline void getObjects(T *dst, size_t count) const {
+            size_t tmp = _position;
+            getObjects<order>(tmp, dst, count);
+            _position = tmp + count * sizeof (T);
+        }
+
+        template<ByteOrder order, typename T>
+        inline void putObjects(const T *src, size_t count) {
+            size_t tmp = _position;
+            putObjects<order>(tmp, src, count);
+            _position = tmp + count * sizeof (T);
+        }
+
+        inline void putVarint(u8 value) {
+            u1 tmp[MAX_VARINT_LENGTH];
+            put(tmp, encodeVarint(value, tmp));
+        }
+
+        inline u8 getVarint() const {
+            size_t tmp = _position;
+            u8 out = decodeVarint(reinterpret_cast<const u1*> (getData()),
+                    _capacity, tmp);
+            _position = tmp;
+            return out;
+        }
+
+        /**
+         * Знаковые числа кодируются в zigzag перед записью в LEB128.
+         */
+        inline void putSignedVarint(s8 value) {
+            putVarint(zigZagEncode(value));
+        }
+
+        inline s8 getSignedVarint() const {
+            return zigZagDecode(getVarint());
+        }
+
+        template<typename T>
+        inline void getVarints(T *dst, size_t count) const {
+            size_t tmp = _position;
+            tmp += decodeVarints(reinterpret_cast<const u1*> (getData()) + tmp,
+                    _capacity - tmp, dst, count);
+            _position = tmp;
+        }
+
+        /**
+         * Участок хранит ссылку на позицию буфера, поэтому создаётся только
+         * от буфера, который его переживёт. Запись в участок не проверяется,
+         * поэтому для буфера только для чтения бросается
+         * ReadOnlyBufferException.
+         */
+        inline ByteBufferRegion region(size_t length) const & {
+            checkWritable();
+            return ByteBufferRegion(getData(), _position, _capacity, length);
+        }
+
+        ByteBufferRegion region(size_t length) const && = delete;
+
         inline const ByteBuffer<true> slice(size_t index, size_t length) const {
             checkRange(index, length, _capacity);
-            return ByteBuffer<true>(ptr_data, start + index, length);
+            ByteBuffer<true> out(ptr_data, start + index, length);
+            out.readOnly = readOnly;
+            return out;
         }
 
         inline ByteBuffer<true> slice(size_t index, size_t length) {
             checkRange(index, length, _capacity);
-            return ByteBuffer<true>(ptr_data, start + index, length);
+            ByteBuffer<true> out(ptr_data, start + index, length);
+            out.readOnly = readOnly;
+            return out;
         }
 
         inline ByteBuffer<true> clone(size_t index, size_t length) const {
@@ -236,8 +625,41 @@ namespace JIO {
         friend ByteBuffer<false>;
     };
 
+    /**
+     * Делит буфер на записи, оканчивающиеся байтом-разделителем. Записи
+     * возвращаются срезами без разделителя, последняя запись может
+     * не оканчиваться им.
+     */
+    class ByteBufferSplitter {
+    private:
+        const ByteBuffer<false> data;
+        size_t position;
+        const u1 delimiter;
+    public:
+
+        inline ByteBufferSplitter(const ByteBuffer<false> &data, u1 delimiter) :
+        data(data), position(0), delimiter(delimiter) { }
+
+        /**
+         * Записывает в <code>out</code> следующую запись. Возвращает false,
+         * если записей больше нет.
+         */
+        inline bool next(ByteBuffer<false> &out) {
+            size_t capacity = data.capacity();
+            if (position >= capacity) {
+                return false;
+            }
+            s8 end = data.indexOf(delimiter, position);
+            size_t length = (end < 0 ? capacity : end) - position;
+            out.set(data.slice(position, length));
+            position += length + 1;
+            return true;
+        }
+    };
+
     inline ByteBuffer<true> ByteBuffer<false>::operator[](size_t pos) {
         ByteBuffer<true> out(ptr_data, start, _capacity);
+        out.readOnly = readOnly;
         out.position(pos);
         return out;
     }
@@ -245,6 +667,7 @@ namespace JIO {
     inline const ByteBuffer<true>
     ByteBuffer<false>::operator[](size_t pos) const {
         ByteBuffer<true> out(ptr_data, start, _capacity);
+        out.readOnly = readOnly;
         out.position(pos);
         return out;
     }
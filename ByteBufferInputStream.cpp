@@ -0,0 +1,102 @@
+#include "ByteBufferStreams.hpp"
+
+using namespace JIO;
+
+ByteBufferInputStream::ByteBufferInputStream(const ByteBuffer<false> &data) :
+data(data),
+position(0) { }
+
+int ByteBufferInputStream::read() {
+    if (position < data.capacity()) {
+        return u1(data.getData()[position++]);
+    }
+    return -1;
+}
+
+s8 ByteBufferInputStream::read(void *buf, s8 offset, s8 length) {
+    if (length == 0) {
+        return 0;
+    }
+
+    checkSBounds(buf, offset, length);
+
+    u8 tmp_pos = position;
+    u8 count = data.capacity();
+    if (tmp_pos >= count) {
+        return -1;
+    }
+
+    u8 avail = count - tmp_pos;
+    if (avail > u8(length)) {
+        avail = length;
+    }
+
+    data.get(tmp_pos, reinterpret_cast<char*> (buf) + offset, avail);
+
+    position = tmp_pos + avail;
+    return avail;
+}
+
+s8 ByteBufferInputStream::skip(s8 n) {
+    s8 tmp_pos = position;
+    s8 k = data.capacity() - tmp_pos;
+    if (n < k) {
+        k = n < 0 ? 0 : n;
+    }
+
+    position = tmp_pos + k;
+    return k;
+}
+
+s8 ByteBufferInputStream::available() {
+    return data.capacity() - position;
+}
+
+s8 ByteBufferInputStream::transferTo(OutputStream &out, s8 max) {
+    if (max < 0) {
+        throw IllegalArgumentException("max < 0");
+    }
+
+    u8 tmp_pos = position;
+    u8 avail = data.capacity() - tmp_pos;
+    if (avail > u8(max)) {
+        avail = max;
+    }
+
+    out.write(data.getData(), tmp_pos, avail);
+
+    position = tmp_pos + avail;
+    return avail;
+}
+
+const u1* ByteBufferInputStream::peek(s8 length) {
+    checkLength(length);
+    if (u8(length) > data.capacity() - position) {
+        return nullptr;
+    }
+    return reinterpret_cast<const u1*> (data.getData()) + position;
+}
+
+const u1* ByteBufferInputStream::borrow(s8 length) {
+    const u1 *out = peek(length);
+    if (out != nullptr) {
+        position += length;
+    }
+    return out;
+}
+
+ByteBuffer<false> ByteBufferInputStream::readSlice(s8 length) {
+    ByteBufferView<false> view = readView(length);
+    return data.slice(view.getData() - data.getData(), length);
+}
+
+ByteBufferView<false> ByteBufferInputStream::readView(s8 length) {
+    checkLength(length);
+    u8 avail = data.capacity() - position;
+    if (u8(length) > avail) {
+        throw EOFException("Required: ", length, " but available: ", avail);
+    }
+    ByteBufferView<false> out = ByteBufferView<false>(data).slice(position, length);
+    position += length;
+    return out;
+}
@@ -0,0 +1,29 @@
+#include "ByteBufferStreams.hpp"
+
+using namespace JIO;
+
+ByteBufferOutputStream::ByteBufferOutputStream(const ByteBuffer<false> &data) :
+data(data),
+position(0) {
+    if (data.isReadOnly()) {
+        throw ReadOnlyBufferException();
+    }
+}
+
+void ByteBufferOutputStream::write(u1 byte) {
+    if (position >= data.capacity()) {
+        throw IOException("Buffer overflow: capacity ", data.capacity());
+    }
+    data.getData()[position++] = byte;
+}
+
+void ByteBufferOutputStream::write(const void *buf, s8 offset, s8 length) {
+    const u1 *src = checkSBounds<const u1*>(buf, offset, length);
+    size_t avail = data.capacity() - position;
+    if (u8(length) > avail) {
+        throw IOException("Buffer overflow: required ", length,
+                " but available ", avail);
+    }
+    std::memmove(data.getData() + position, src, length);
+    position += length;
+}
@@ -0,0 +1,92 @@
+#ifndef BYTEBUFFERSTREAMS_HPP
+#define BYTEBUFFERSTREAMS_HPP
+
+#include "ByteBufferView.hpp"
+#include "Streams.hpp"
+
+namespace JIO {
+
+    /**
+     * Поток чтения из ByteBuffer. Буфер удерживается потоком, поэтому
+     * указатели из <code>peek</code> и <code>borrow</code>, а также срезы
+     * из <code>readSlice</code> остаются действительными всё время его
+     * жизни.
+     */
+    class ByteBufferInputStream : public InputStream {
+    public:
+        ByteBufferInputStream(const ByteBuffer<false> &data);
+
+        using InputStream::read;
+        using InputStream::transferTo;
+        using InputStream::borrow;
+        virtual int read() override;
+        virtual s8 read(void *buf, s8 offset, s8 length) override;
+        virtual s8 skip(s8 count) override;
+        virtual s8 available() override;
+        virtual s8 transferTo(OutputStream &out, s8 max) override;
+        virtual const u1* peek(s8 length) override;
+        virtual const u1* borrow(s8 length) override;
+
+        /**
+         * Читает <code>length</code> байт в виде среза, разделяющего память
+         * с исходным буфером. Если данных не хватает, бросается EOFException.
+         */
+        ByteBuffer<false> readSlice(s8 length);
+
+        /**
+         * То же, что <code>readSlice</code>, но без изменения счётчика
+         * ссылок: представление действительно, пока жив поток.
+         */
+        ByteBufferView<false> readView(s8 length);
+
+        inline const ByteBuffer<false> getBuffer() const {
+            return data;
+        }
+
+        inline virtual ~ByteBufferInputStream() override { }
+    private:
+        const ByteBuffer<false> data;
+        u8 position;
+        ByteBufferInputStream(const ByteBufferInputStream&);
+        ByteBufferInputStream& operator=(const ByteBufferInputStream&);
+    };
+
+    /**
+     * Поток записи в ByteBuffer фиксированного размера. При попытке
+     * записать больше, чем помещается в буфер, бросается IOException,
+     * а буфер не изменяется.
+     */
+    class ByteBufferOutputStream : public OutputStream {
+    public:
+        ByteBufferOutputStream(const ByteBuffer<false> &data);
+
+        using OutputStream::write;
+        virtual void write(u1 byte) override;
+        virtual void write(const void *buf, s8 offset, s8 length) override;
+
+        inline size_t size() const {
+            return position;
+        }
+
+        inline const ByteBuffer<false> getBuffer() const {
+            return data;
+        }
+
+        /**
+         * Записанная часть буфера, без копирования.
+         */
+        inline ByteBuffer<false> getWritten() const {
+            return data.slice(0, position);
+        }
+
+        inline virtual ~ByteBufferOutputStream() override { }
+    private:
+        const ByteBuffer<false> data;
+        size_t position;
+        ByteBufferOutputStream(const ByteBufferOutputStream&);
+        ByteBufferOutputStream& operator=(const ByteBufferOutputStream&);
+    };
+}
+
+#endif /* BYTEBUFFERSTREAMS_HPP */
+
@@ -0,0 +1,365 @@
+#ifndef BYTEBUFFERVIEW_HPP
+#define BYTEBUFFERVIEW_HPP
+
+#include <cstring>
+#include <type_traits>
+#include "ByteBuffer.hpp"
+
+namespace JIO {
+
+    template<bool>
+    class ByteBufferView;
+
+    /**
+     * Невладеющее представление участка памяти с тем же интерфейсом, что
+     * и у ByteBuffer. Копирование и срезы не изменяют счётчики ссылок,
+     * поэтому представление не должно переживать буфер, из которого
+     * получено. Владеющий буфер без атомарного счётчика ссылок -
+     * LocalByteBuffer.
+     */
+    template<>
+    class ByteBufferView<false> {
+    protected:
+        char *data;
+        size_t _capacity;
+        bool readOnly = false;
+
+        inline void checkWritable() const {
+            if (readOnly) {
+                throw ReadOnlyBufferException();
+            }
+        }
+    public:
+
+        inline ByteBufferView(void *ptr, size_t start, size_t capacity) :
+        data(checkUBounds<char*>(ptr, start, capacity)),
+        _capacity(capacity) { }
+
+        inline ByteBufferView(const ByteBuffer<false> &buf) :
+        data(buf.getData()), _capacity(buf.capacity()),
+        readOnly(buf.isReadOnly()) { }
+
+        inline size_t capacity() const {
+            return _capacity;
+        }
+
+        inline bool isReadOnly() const {
+            return readOnly;
+        }
+
+        inline char* getData() const {
+            return data;
+        }
+
+        inline void get(size_t index, void *dst, size_t length) const {
+            checkRange(index, length, _capacity);
+            std::memmove(dst, data + index, length);
+        }
+
+        inline void put(size_t index, const void *src, size_t length) {
+            checkWritable();
+            checkRange(index, length, _capacity);
+            std::memmove(data + index, src, length);
+        }
+
+        inline void get(size_t index, const ByteBufferView &dst,
+                size_t offset, size_t length) const {
+            dst.checkWritable();
+            checkRange(index, length, _capacity);
+            checkRange(offset, length, dst._capacity);
+            std::memmove(dst.data + offset, data + index, length);
+        }
+
+        inline void put(size_t index, const ByteBufferView &src,
+                size_t offset, size_t length) {
+            checkWritable();
+            checkRange(index, length, _capacity);
+            checkRange(offset, length, src._capacity);
+            std::memmove(data + index, src.data + offset, length);
+        }
+
+        template<typename T>
+        inline void getObject(size_t index, T &obj) const {
+            get(index, &obj, sizeof (T));
+        }
+
+        template<typename T>
+        inline void putObject(size_t index, const T &obj) {
+            put(index, &obj, sizeof (T));
+        }
+
+        template<ByteOrder order, typename T>
+        inline void getObject(size_t index, T &obj) const {
+            getObject(index, obj);
+            obj = convertOrder<order>(obj);
+        }
+
+        template<ByteOrder order, typename T>
+        inline T getObject(size_t index) const {
+            T out;
+            getObject<order>(index, out);
+            return out;
+        }
+
+        template<ByteOrder order, typename T>
+        inline void putObject(size_t index, T obj) {
+            putObject(index, convertOrder<order>(obj));
+        }
+
+        template<typename T>
+        inline void getObjects(size_t index, T *dst, size_t count) const {
+            static_assert(std::is_trivially_copyable<T>::value,
+                    "T must be trivially copyable");
+            get(index, dst, checkArrayLength(count, sizeof (T)));
+        }
+
+        template<typename T>
+        inline void putObjects(size_t index, const T *src, size_t count) {
+            static_assert(std::is_trivially_copyable<T>::value,
+                    "T must be trivially copyable");
+            put(index, src, checkArrayLength(count, sizeof (T)));
+        }
+
+        template<ByteOrder order, typename T>
+        inline void getObjects(size_t index, T *dst, size_t count) const {
+            getObjects(index, dst, count);
+            convertOrder<order>(dst, dst, count);
+        }
+
+        template<ByteOrder order, typename T>
+        inline void putObjects(size_t index, const T *src, size_t count) {
+            checkWritable();
+            checkRange(index, checkArrayLength(count, sizeof (T)), _capacity);
+            convertOrderUnaligned<order, T>(data + index, src, count);
+        }
+
+        inline s8 indexOf(u1 value, size_t fromIndex = 0) const {
+            if (fromIndex >= _capacity) {
+                return -1;
+            }
+            s8 out = indexOfByte(data + fromIndex,
+                    _capacity - fromIndex, value);
+            return out < 0 ? -1 : out + fromIndex;
+        }
+
+        inline s8 indexOf(const void *pattern, size_t length,
+                size_t fromIndex = 0) const {
+            if (fromIndex > _capacity) {
+                return -1;
+            }
+            s8 out = indexOfBytes(data + fromIndex,
+                    _capacity - fromIndex, pattern, length);
+            return out < 0 ? -1 : out + fromIndex;
+        }
+
+        inline s8 lastIndexOf(u1 value) const {
+            return lastIndexOfByte(data, _capacity, value);
+        }
+
+        inline size_t count(u1 value) const {
+            return countByte(data, _capacity, value);
+        }
+
+        inline void copy(size_t fromIndex, size_t toIndex, size_t length) {
+            checkWritable();
+            checkRange(fromIndex, length, _capacity);
+            checkRange(toIndex, length, _capacity);
+            std::memmove(data + toIndex, data + fromIndex, length);
+        }
+
+        inline ByteBufferView slice(size_t index, size_t length) const {
+            checkRange(index, length, _capacity);
+            ByteBufferView out(data, index, length);
+            out.readOnly = readOnly;
+            return out;
+        }
+
+        inline ByteBuffer<false> clone(size_t index, size_t length) const {
+            checkRange(index, length, _capacity);
+            ByteBuffer<false> out(length);
+            get(index, out.getData(), length);
+            return out;
+        }
+
+        inline ByteBuffer<false> clone() const {
+            return clone(0, _capacity);
+        }
+
+        ByteBufferView<true> operator[](size_t) const;
+    };
+
+    template<>
+    class ByteBufferView <true> : public ByteBufferView<false> {
+    private:
+        mutable size_t _position;
+    public:
+
+        inline ByteBufferView(void *ptr, size_t start, size_t capacity) :
+        ByteBufferView<false>(ptr, start, capacity), _position(0) { }
+
+        inline ByteBufferView(const ByteBuffer<false> &buf) :
+        ByteBufferView<false>(buf), _position(0) { }
+
+        inline ByteBufferView(const ByteBuffer<true> &buf) :
+        ByteBufferView<false>(buf), _position(buf.position()) { }
+
+        using ByteBufferView<false>::get;
+        using ByteBufferView<false>::put;
+        using ByteBufferView<false>::getObject;
+        using ByteBufferView<false>::putObject;
+        using ByteBufferView<false>::getObjects;
+        using ByteBufferView<false>::putObjects;
+
+        inline void get(void *dst, size_t length) const {
+            size_t tmp = _position;
+            get(tmp, dst, length);
+            _position = tmp + length;
+        }
+
+        inline void put(const void *src, size_t length) {
+            size_t tmp = _position;
+            put(tmp, src, length);
+            _position = tmp + length;
+        }
+
+        template<typename T>
+        inline void getObject(T &obj) const {
+            get(&obj, sizeof (T));
+        }
+
+        template<typename T>
+        inline void putObject(const T &obj) {
+            put(&obj, sizeof (T));
+        }
+
+        template<ByteOrder order, typename T>
+        inline void getObject(T &obj) const {
+            getObject(obj);
+            obj = convertOrder<order>(obj);
+        }
+
+        template<ByteOrder order, typename T>
+        inline T getObject() const {
+            T out;
+            getObject<order>(out);
+            return out;
+        }
+
+        template<ByteOrder order, typename T>
+        inline void putObject(T obj) {
+            putObject(convertOrder<order>(obj));
+        }
+
+        template<typename T>
+        inline void getObjects(T *dst, size_t count) const {
+            size_t tmp = _position;
+            getObjects(tmp, dst, count);
+            _position = tmp + count * sizeof (T);
+        }
+
+        template<typename T>
+        inline void putObjects(const T *src, size_t count) {
+            size_t tmp = _position;
+            putObjects(tmp, src, count);
+            _position = tmp + count * sizeof (T);
+        }
+
+        template<ByteOrder order, typename T>
+        inline void getObjects(T *dst, size_t count) const {
+            size_t tmp = _position;
+            getObjects<order>(tmp, dst, count);
+            _position = tmp + count * sizeof (T);
+        }
+
+        template<ByteOrder order, typename T>
+        inline void putObjects(const T *src, size_t count) {
+            size_t tmp = _position;
+            putObjects<order>(tmp, src, count);
+            _position = tmp + count * sizeof (T);
+        }
+
+        inline void putVarint(u8 value) {
+            u1 tmp[MAX_VARINT_LENGTH];
+            put(tmp, encodeVarint(value, tmp));
+        }
+
+        inline u8 getVarint() const {
+            size_t tmp = _position;
+            u8 out = decodeVarint(reinterpret_cast<const u1*> (data),
+                    _capacity, tmp);
+            _position = tmp;
+            return out;
+        }
+
+        inline void putSignedVarint(s8 value) {
+            putVarint(zigZagEncode(value));
+        }
+
+        inline s8 getSignedVarint() const {
+            return zigZagDecode(getVarint());
+        }
+
+        template<typename T>
+        inline void getVarints(T *dst, size_t count) const {
+            size_t tmp = _position;
+            tmp += decodeVarints(reinterpret_cast<const u1*> (data) + tmp,
+                    _capacity - tmp, dst, count);
+            _position = tmp;
+        }
+
+        inline ByteBufferRegion region(size_t length) const & {
+            checkWritable();
+            return ByteBufferRegion(data, _position, _capacity, length);
+        }
+
+        ByteBufferRegion region(size_t length) const && = delete;
+
+        inline ByteBufferView<true> slice(size_t index, size_t length) const {
+            checkRange(index, length, _capacity);
+            ByteBufferView<true> out(data, index, length);
+            out.readOnly = readOnly;
+            return out;
+        }
+
+        inline size_t position() const {
+            return _position;
+        }
+
+        inline void position(size_t newPosition) const {
+            if (newPosition > _capacity) {
+                throw IllegalArgumentException(
+                        "newPosition > capacity: (",
+                        newPosition, " > ", _capacity, ")");
+            }
+            _position = newPosition;
+        }
+
+        template<typename T>
+        ByteBufferView<true>& operator<<(T obj) {
+            putObject(obj);
+            return *this;
+        }
+
+        template<typename T>
+        const ByteBufferView<true>& operator>>(T &obj) const {
+            getObject(obj);
+            return *this;
+        }
+
+        template<typename T>
+        ByteBufferView<true>& operator>>(T &obj) {
+            getObject(obj);
+            return *this;
+        }
+    };
+
+    inline ByteBufferView<true> ByteBufferView<false>::operator[](size_t pos) const {
+        ByteBufferView<true> out(data, 0, _capacity);
+        out.readOnly = readOnly;
+        out.position(pos);
+        return out;
+    }
+}
+
+#endif /* BYTEBUFFERVIEW_HPP */
+
@@ -0,0 +1,119 @@
+#include "ByteOrder.hpp"
+#include "exceptions.hpp"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define JIO_X86
+#endif
+
+using namespace JIO;
+
+template<typename U>
+static void swapScalar(u1 *dst, const u1 *src, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        U tmp;
+        std::memcpy(&tmp, src + i * sizeof (U), sizeof (U));
+        tmp = swapBytes(tmp);
+        std::memcpy(dst + i * sizeof (U), &tmp, sizeof (U));
+    }
+}
+
+#ifdef JIO_X86
+
+alignas(32) static const u1 SHUFFLE_MASKS[3][32] = {
+    {1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14,
+        1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14},
+    {3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12,
+        3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12},
+    {7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8,
+        7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8}
+};
+
+//Возвращают количество обработанных байт, остаток обрабатывается скалярно
+
+__attribute__((target("avx2")))
+static size_t swapAVX2(u1 *dst, const u1 *src, size_t bytes, const u1 *mask) {
+    const __m256i m = _mm256_load_si256(reinterpret_cast<const __m256i*> (mask));
+    size_t i = 0;
+    for (; i + 64 <= bytes; i += 64) {
+        __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*> (src + i));
+        __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*> (src + i + 32));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*> (dst + i), _mm256_shuffle_epi8(a, m));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*> (dst + i + 32), _mm256_shuffle_epi8(b, m));
+    }
+    for (; i + 32 <= bytes; i += 32) {
+        __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*> (src + i));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*> (dst + i), _mm256_shuffle_epi8(a, m));
+    }
+    return i;
+}
+
+__attribute__((target("ssse3")))
+static size_t swapSSSE3(u1 *dst, const u1 *src, size_t bytes, const u1 *mask) {
+    const __m128i m = _mm_load_si128(reinterpret_cast<const __m128i*> (mask));
+    size_t i = 0;
+    for (; i + 16 <= bytes; i += 16) {
+        __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*> (src + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i*> (dst + i), _mm_shuffle_epi8(a, m));
+    }
+    return i;
+}
+
+typedef size_t(*swap_kernel)(u1*, const u1*, size_t, const u1*);
+
+static swap_kernel selectKernel() {
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        return swapAVX2;
+    }
+    if (__builtin_cpu_supports("ssse3")) {
+        return swapSSSE3;
+    }
+    return nullptr;
+}
+
+static const swap_kernel SWAP_KERNEL = selectKernel();
+
+#endif
+
+void JIO::swapBytes(void *dst, const void *src, size_t count, size_t size) {
+    u1 *d = reinterpret_cast<u1*> (dst);
+    const u1 *s = reinterpret_cast<const u1*> (src);
+    size_t done = 0;
+
+    switch (size) {
+        case 1:
+            if (d != s) {
+                std::memmove(d, s, count);
+            }
+            return;
+        case 2:
+        case 4:
+        case 8:
+            break;
+        default:
+            throw IllegalArgumentException("Unsupported element size: ", size);
+    }
+
+#ifdef JIO_X86
+    if (SWAP_KERNEL != nullptr) {
+        const u1 *mask = SHUFFLE_MASKS[size == 2 ? 0 : (size == 4 ? 1 : 2)];
+        done = SWAP_KERNEL(d, s, count * size, mask) / size;
+    }
+#endif
+
+    d += done * size;
+    s += done * size;
+    count -= done;
+    switch (size) {
+        case 2:
+            swapScalar<u2>(d, s, count);
+            break;
+        case 4:
+            swapScalar<u4>(d, s, count);
+            break;
+        case 8:
+            swapScalar<u8>(d, s, count);
+            break;
+    }
+}
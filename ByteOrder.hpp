@@ -0,0 +1,118 @@
+#ifndef BYTEORDER_HPP
+#define BYTEORDER_HPP
+
+#include <cstring>
+#include <type_traits>
+#include "jtypes.hpp"
+
+namespace JIO {
+
+    enum class ByteOrder {
+        BIG, LITTLE
+    };
+
+    constexpr const ByteOrder NATIVE_ORDER =
+            __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__ ?
+            ByteOrder::BIG : ByteOrder::LITTLE;
+
+    inline u1 swapBytes(u1 value) {
+        return value;
+    }
+
+    inline u2 swapBytes(u2 value) {
+        return __builtin_bswap16(value);
+    }
+
+    inline u4 swapBytes(u4 value) {
+        return __builtin_bswap32(value);
+    }
+
+    inline u8 swapBytes(u8 value) {
+        return __builtin_bswap64(value);
+    }
+
+    namespace byteorder_detail {
+
+        template<size_t size>
+        struct uint_of_size;
+
+        template<>
+        struct uint_of_size<1> {
+            typedef u1 type;
+        };
+
+        template<>
+        struct uint_of_size<2> {
+            typedef u2 type;
+        };
+
+        template<>
+        struct uint_of_size<4> {
+            typedef u4 type;
+        };
+
+        template<>
+        struct uint_of_size<8> {
+            typedef u8 type;
+        };
+    }
+
+    template<typename T>
+    inline T swapBytes(T value) {
+        static_assert(std::is_arithmetic<T>::value || std::is_enum<T>::value,
+                "T must be arithmetic or enum type");
+        typedef typename byteorder_detail::uint_of_size<sizeof (T)>::type U;
+        U tmp;
+        std::memcpy(&tmp, &value, sizeof (T));
+        tmp = swapBytes(tmp);
+        std::memcpy(&value, &tmp, sizeof (T));
+        return value;
+    }
+
+    /**
+     * Преобразует значение между порядком байт <code>order</code> и
+     * порядком байт платформы. Преобразование симметрично.
+     */
+    template<ByteOrder order, typename T>
+    inline T convertOrder(T value) {
+        if (order == NATIVE_ORDER) {
+            return value;
+        }
+        return swapBytes(value);
+    }
+
+    /**
+     * Меняет порядок байт в каждом из <code>count</code> элементов размера
+     * <code>size</code> (1, 2, 4 или 8) из <code>src</code> и записывает
+     * результат в <code>dst</code>. Массивы должны совпадать или
+     * не пересекаться. Используются SSSE3/AVX2, если процессор их
+     * поддерживает.
+     */
+    void swapBytes(void *dst, const void *src, size_t count, size_t size);
+
+    /**
+     * Массивы могут быть не выровнены по <code>T</code>, например лежать
+     * внутри ByteBuffer по произвольному индексу.
+     */
+    template<ByteOrder order, typename T>
+    inline void convertOrderUnaligned(void *dst, const void *src,
+            size_t count) {
+        static_assert(std::is_arithmetic<T>::value || std::is_enum<T>::value,
+                "T must be arithmetic or enum type");
+        if (order == NATIVE_ORDER || sizeof (T) == 1) {
+            if (dst != src) {
+                std::memmove(dst, src, count * sizeof (T));
+            }
+            return;
+        }
+        swapBytes(dst, src, count, sizeof (T));
+    }
+
+    template<ByteOrder order, typename T>
+    inline void convertOrder(T *dst, const T *src, size_t count) {
+        convertOrderUnaligned<order, T>(dst, src, count);
+    }
+}
+
+#endif /* BYTEORDER_HPP */
+
@@ -0,0 +1,337 @@
+#include <algorithm>
+#include <cstring>
+#include "ByteSearch.hpp"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define JIO_X86
+#endif
+
+using namespace JIO;
+
+//Ядра работают с промежутком [p, end) и возвращают nullptr, если байт не найден
+
+static const u1* findScalar(const u1 *p, const u1 *end, u1 value) {
+    for (; p < end; p++) {
+        if (*p == value) {
+            return p;
+        }
+    }
+    return nullptr;
+}
+
+static const u1* findLastScalar(const u1 *begin, const u1 *p, u1 value) {
+    while (p > begin) {
+        if (*--p == value) {
+            return p;
+        }
+    }
+    return nullptr;
+}
+
+static size_t countScalar(const u1 *p, const u1 *end, u1 value) {
+    size_t out = 0;
+    for (; p < end; p++) {
+        out += *p == value;
+    }
+    return out;
+}
+
+static const u1* findPatternScalar(const u1 *p, const u1 *end,
+        const u1 *pattern, size_t m) {
+    const u1 *last = end - m;
+    while (p <= last) {
+        p = reinterpret_cast<const u1*> (std::memchr(p, pattern[0], last - p + 1));
+        if (p == nullptr) {
+            return nullptr;
+        }
+        if (std::memcmp(p + 1, pattern + 1, m - 1) == 0) {
+            return p;
+        }
+        p++;
+    }
+    return nullptr;
+}
+
+#ifdef JIO_X86
+
+__attribute__((target("sse2")))
+static inline unsigned eqMaskSSE2(const u1 *p, __m128i v) {
+    __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*> (p));
+    return _mm_movemask_epi8(_mm_cmpeq_epi8(a, v));
+}
+
+__attribute__((target("sse2")))
+static inline size_t sum64(__m128i v) {
+    alignas(16) u8 tmp[2];
+    _mm_store_si128(reinterpret_cast<__m128i*> (tmp), v);
+    return tmp[0] + tmp[1];
+}
+
+__attribute__((target("sse2")))
+static const u1* findSSE2(const u1 *p, const u1 *end, u1 value) {
+    const u1 *begin = p;
+    const __m128i v = _mm_set1_epi8(value);
+    for (; end - p >= 16; p += 16) {
+        unsigned mask = eqMaskSSE2(p, v);
+        if (mask != 0) {
+            return p + __builtin_ctz(mask);
+        }
+    }
+    if (p == end || end - begin < 16) {
+        return findScalar(p, end, value);
+    }
+    //Последний блок перекрывается с уже проверенными байтами
+    const u1 *q = end - 16;
+    unsigned mask = eqMaskSSE2(q, v) >> (p - q);
+    return mask != 0 ? p + __builtin_ctz(mask) : nullptr;
+}
+
+__attribute__((target("sse2")))
+static const u1* findLastSSE2(const u1 *begin, const u1 *p, u1 value) {
+    const u1 *end = p;
+    const __m128i v = _mm_set1_epi8(value);
+    for (; p - begin >= 16; p -= 16) {
+        unsigned mask = eqMaskSSE2(p - 16, v);
+        if (mask != 0) {
+            return p - 16 + (31 - __builtin_clz(mask));
+        }
+    }
+    if (p == begin || end - begin < 16) {
+        return findLastScalar(begin, p, value);
+    }
+    unsigned mask = eqMaskSSE2(begin, v) & ((1u << (p - begin)) - 1);
+    return mask != 0 ? begin + (31 - __builtin_clz(mask)) : nullptr;
+}
+
+__attribute__((target("sse2")))
+static size_t countSSE2(const u1 *p, const u1 *end, u1 value) {
+    const u1 *begin = p;
+    const __m128i v = _mm_set1_epi8(value);
+    const __m128i zero = _mm_setzero_si128();
+    __m128i total = zero;
+    while (end - p >= 16) {
+        //Байтовые счётчики переполнятся после 255 блоков
+        size_t blocks = std::min<size_t>((end - p) / 16, 255);
+        __m128i acc = zero;
+        for (size_t i = 0; i < blocks; i++, p += 16) {
+            __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*> (p));
+            acc = _mm_sub_epi8(acc, _mm_cmpeq_epi8(a, v));
+        }
+        total = _mm_add_epi64(total, _mm_sad_epu8(acc, zero));
+    }
+    size_t out = sum64(total);
+    if (p == end || end - begin < 16) {
+        return out + countScalar(p, end, value);
+    }
+    const u1 *q = end - 16;
+    return out + __builtin_popcount(eqMaskSSE2(q, v) >> (p - q));
+}
+
+__attribute__((target("sse2")))
+static const u1* findPatternSSE2(const u1 *p, const u1 *end,
+        const u1 *pattern, size_t m) {
+    const __m128i first = _mm_set1_epi8(pattern[0]);
+    const __m128i last = _mm_set1_epi8(pattern[m - 1]);
+    //Кандидаты: совпадают первый и последний байт образца
+    for (; size_t(end - p) >= m - 1 + 16; p += 16) {
+        unsigned mask = eqMaskSSE2(p, first) & eqMaskSSE2(p + m - 1, last);
+        while (mask != 0) {
+            const u1 *c = p + __builtin_ctz(mask);
+            if (std::memcmp(c + 1, pattern + 1, m - 2) == 0) {
+                return c;
+            }
+            mask &= mask - 1;
+        }
+    }
+    return findPatternScalar(p, end, pattern, m);
+}
+
+__attribute__((target("avx2")))
+static inline unsigned eqMaskAVX2(const u1 *p, __m256i v) {
+    __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*> (p));
+    return _mm256_movemask_epi8(_mm256_cmpeq_epi8(a, v));
+}
+
+__attribute__((target("avx2")))
+static const u1* findAVX2(const u1 *p, const u1 *end, u1 value) {
+    const u1 *begin = p;
+    const __m256i v = _mm256_set1_epi8(value);
+    if (end - p >= 160) {
+        unsigned mask = eqMaskAVX2(p, v);
+        if (mask != 0) {
+            return p + __builtin_ctz(mask);
+        }
+        //Дальше загрузки не пересекают границы строк кэша
+        p = reinterpret_cast<const u1*> ((uintptr_t(p) + 32) & ~uintptr_t(31));
+    }
+    for (; end - p >= 128; p += 128) {
+        const __m256i *x = reinterpret_cast<const __m256i*> (p);
+        __m256i a = _mm256_cmpeq_epi8(_mm256_loadu_si256(x + 0), v);
+        __m256i b = _mm256_cmpeq_epi8(_mm256_loadu_si256(x + 1), v);
+        __m256i c = _mm256_cmpeq_epi8(_mm256_loadu_si256(x + 2), v);
+        __m256i d = _mm256_cmpeq_epi8(_mm256_loadu_si256(x + 3), v);
+        //Точное положение ищется, только если совпадение есть в блоке
+        __m256i any = _mm256_or_si256(_mm256_or_si256(a, b), _mm256_or_si256(c, d));
+        if (!_mm256_testz_si256(any, any)) {
+            u8 lo = unsigned(_mm256_movemask_epi8(a))
+                    | (u8(unsigned(_mm256_movemask_epi8(b))) << 32);
+            if (lo != 0) {
+                return p + __builtin_ctzll(lo);
+            }
+            u8 hi = unsigned(_mm256_movemask_epi8(c))
+                    | (u8(unsigned(_mm256_movemask_epi8(d))) << 32);
+            return p + 64 + __builtin_ctzll(hi);
+        }
+    }
+    for (; end - p >= 32; p += 32) {
+        unsigned mask = eqMaskAVX2(p, v);
+        if (mask != 0) {
+            return p + __builtin_ctz(mask);
+        }
+    }
+    if (p == end || end - begin < 32) {
+        return findSSE2(p, end, value);
+    }
+    const u1 *q = end - 32;
+    unsigned mask = eqMaskAVX2(q, v) >> (p - q);
+    return mask != 0 ? p + __builtin_ctz(mask) : nullptr;
+}
+
+__attribute__((target("avx2")))
+static const u1* findLastAVX2(const u1 *begin, const u1 *p, u1 value) {
+    const u1 *end = p;
+    const __m256i v = _mm256_set1_epi8(value);
+    for (; p - begin >= 32; p -= 32) {
+        unsigned mask = eqMaskAVX2(p - 32, v);
+        if (mask != 0) {
+            return p - 32 + (31 - __builtin_clz(mask));
+        }
+    }
+    if (p == begin || end - begin < 32) {
+        return findLastSSE2(begin, p, value);
+    }
+    unsigned mask = eqMaskAVX2(begin, v) & ((1u << (p - begin)) - 1);
+    return mask != 0 ? begin + (31 - __builtin_clz(mask)) : nullptr;
+}
+
+__attribute__((target("avx2")))
+static size_t countAVX2(const u1 *p, const u1 *end, u1 value) {
+    const u1 *begin = p;
+    const __m256i v = _mm256_set1_epi8(value);
+    const __m256i zero = _mm256_setzero_si256();
+    __m256i total = zero;
+    size_t head = 0;
+    if (end - p >= 128) {
+        size_t skip = -uintptr_t(p) & 31;
+        head = __builtin_popcount(eqMaskAVX2(p, v) & ((1u << skip) - 1));
+        p += skip;
+    }
+    while (end - p >= 64) {
+        size_t blocks = std::min<size_t>((end - p) / 64, 255);
+        __m256i acc1 = zero, acc2 = zero;
+        for (size_t i = 0; i < blocks; i++, p += 64) {
+            const __m256i *x = reinterpret_cast<const __m256i*> (p);
+            acc1 = _mm256_sub_epi8(acc1, _mm256_cmpeq_epi8(_mm256_loadu_si256(x), v));
+            acc2 = _mm256_sub_epi8(acc2, _mm256_cmpeq_epi8(_mm256_loadu_si256(x + 1), v));
+        }
+        total = _mm256_add_epi64(total, _mm256_sad_epu8(acc1, zero));
+        total = _mm256_add_epi64(total, _mm256_sad_epu8(acc2, zero));
+    }
+    for (; end - p >= 32; p += 32) {
+        head += __builtin_popcount(eqMaskAVX2(p, v));
+    }
+    __m128i sum = _mm_add_epi64(_mm256_castsi256_si128(total),
+            _mm256_extracti128_si256(total, 1));
+    size_t out = head + sum64(sum);
+    if (p == end || end - begin < 32) {
+        return out + countSSE2(p, end, value);
+    }
+    const u1 *q = end - 32;
+    return out + __builtin_popcount(eqMaskAVX2(q, v) >> (p - q));
+}
+
+__attribute__((target("avx2")))
+static const u1* findPatternAVX2(const u1 *p, const u1 *end,
+        const u1 *pattern, size_t m) {
+    const __m256i first = _mm256_set1_epi8(pattern[0]);
+    const __m256i last = _mm256_set1_epi8(pattern[m - 1]);
+    for (; size_t(end - p) >= m - 1 + 32; p += 32) {
+        unsigned mask = eqMaskAVX2(p, first) & eqMaskAVX2(p + m - 1, last);
+        while (mask != 0) {
+            const u1 *c = p + __builtin_ctz(mask);
+            if (std::memcmp(c + 1, pattern + 1, m - 2) == 0) {
+                return c;
+            }
+            mask &= mask - 1;
+        }
+    }
+    return findPatternScalar(p, end, pattern, m);
+}
+
+#endif
+
+namespace {
+
+    struct SearchKernels {
+        const u1* (*find)(const u1*, const u1*, u1);
+        const u1* (*findLast)(const u1*, const u1*, u1);
+        size_t(*count)(const u1*, const u1*, u1);
+        const u1* (*findPattern)(const u1*, const u1*, const u1*, size_t);
+    };
+
+    SearchKernels selectKernels() {
+#ifdef JIO_X86
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx2")) {
+            return {findAVX2, findLastAVX2, countAVX2, findPatternAVX2};
+        }
+        if (__builtin_cpu_supports("sse2")) {
+            return {findSSE2, findLastSSE2, countSSE2, findPatternSSE2};
+        }
+#endif
+        return {findScalar, findLastScalar, countScalar, findPatternScalar};
+    }
+
+    //Выбор при первом вызове: функции могут вызываться из статической
+    //инициализации других единиц трансляции
+    const SearchKernels& kernels() {
+        static const SearchKernels out = selectKernels();
+        return out;
+    }
+}
+
+static inline s8 indexIn(const void *data, const u1 *found) {
+    return found == nullptr ? -1 : found - reinterpret_cast<const u1*> (data);
+}
+
+s8 JIO::indexOfByte(const void *data, size_t length, u1 value) {
+    const u1 *p = reinterpret_cast<const u1*> (data);
+    return indexIn(data, kernels().find(p, p + length, value));
+}
+
+s8 JIO::lastIndexOfByte(const void *data, size_t length, u1 value) {
+    const u1 *p = reinterpret_cast<const u1*> (data);
+    return indexIn(data, kernels().findLast(p, p + length, value));
+}
+
+s8 JIO::indexOfBytes(const void *data, size_t length,
+        const void *pattern, size_t patternLength) {
+    const u1 *p = reinterpret_cast<const u1*> (data);
+    const u1 *pat = reinterpret_cast<const u1*> (pattern);
+    if (patternLength == 0) {
+        return 0;
+    }
+    if (patternLength > length) {
+        return -1;
+    }
+    if (patternLength == 1) {
+        return indexIn(data, kernels().find(p, p + length, pat[0]));
+    }
+    return indexIn(data, kernels().findPattern(p, p + length, pat, patternLength));
+}
+
+size_t JIO::countByte(const void *data, size_t length, u1 value) {
+    const u1 *p = reinterpret_cast<const u1*> (data);
+    return kernels().count(p, p + length, value);
+}
@@ -0,0 +1,30 @@
+#ifndef BYTESEARCH_HPP
+#define BYTESEARCH_HPP
+
+#include <cstddef>
+#include "jtypes.hpp"
+
+namespace JIO {
+
+    /**
+     * Поиск и подсчёт байт в памяти. Используются SSE2/AVX2, если
+     * процессор их поддерживает. Функции поиска возвращают индекс
+     * относительно <code>data</code> или -1, если ничего не найдено.
+     */
+
+    s8 indexOfByte(const void *data, size_t length, u1 value);
+
+    s8 lastIndexOfByte(const void *data, size_t length, u1 value);
+
+    /**
+     * Ищет первое вхождение последовательности <code>pattern</code>.
+     * Пустая последовательность находится в начале данных.
+     */
+    s8 indexOfBytes(const void *data, size_t length,
+            const void *pattern, size_t patternLength);
+
+    size_t countByte(const void *data, size_t length, u1 value);
+}
+
+#endif /* BYTESEARCH_HPP */
+
@@ -0,0 +1,388 @@
+#include <cstring>
+#include "ByteOrder.hpp"
+#include "Checksum.hpp"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define JIO_X86
+#endif
+
+using namespace JIO;
+
+static inline u4 read32(const u1 *p) {
+    u4 out;
+    std::memcpy(&out, p, 4);
+    return convertOrder<ByteOrder::LITTLE>(out);
+}
+
+static inline u8 read64(const u1 *p) {
+    u8 out;
+    std::memcpy(&out, p, 8);
+    return convertOrder<ByteOrder::LITTLE>(out);
+}
+
+namespace {
+
+    constexpr u4 CRC32_POLY = 0xedb88320;
+    constexpr u4 CRC32C_POLY = 0x82f63b78;
+
+    //Таблицы строятся при компиляции: функции могут вызываться из
+    //статической инициализации других единиц трансляции
+    struct SlicingTables {
+        u4 table[8][256] = {};
+
+        constexpr SlicingTables(u4 poly) {
+            for (u4 i = 0; i < 256; i++) {
+                u4 c = i;
+                for (int k = 0; k < 8; k++) {
+                    c = c & 1 ? (c >> 1) ^ poly : c >> 1;
+                }
+                table[0][i] = c;
+            }
+            for (u4 i = 0; i < 256; i++) {
+                for (int k = 1; k < 8; k++) {
+                    u4 c = table[k - 1][i];
+                    table[k][i] = (c >> 8) ^ table[0][c & 0xff];
+                }
+            }
+        }
+    };
+
+    constexpr SlicingTables CRC32_TABLES(CRC32_POLY);
+    constexpr SlicingTables CRC32C_TABLES(CRC32C_POLY);
+}
+
+//Ядра работают с состоянием CRC без начальной и конечной инверсии
+
+static u4 crcSlicing8(const SlicingTables &tables, u4 crc,
+        const u1 *p, size_t n) {
+    const u4(*t)[256] = tables.table;
+    for (; n > 0 && (uintptr_t(p) & 7) != 0; n--) {
+        crc = t[0][(crc ^ *p++) & 0xff] ^ (crc >> 8);
+    }
+    for (; n >= 8; n -= 8, p += 8) {
+        u4 lo = read32(p) ^ crc;
+        u4 hi = read32(p + 4);
+        crc = t[7][lo & 0xff] ^ t[6][(lo >> 8) & 0xff]
+                ^ t[5][(lo >> 16) & 0xff] ^ t[4][lo >> 24]
+                ^ t[3][hi & 0xff] ^ t[2][(hi >> 8) & 0xff]
+                ^ t[1][(hi >> 16) & 0xff] ^ t[0][hi >> 24];
+    }
+    for (; n > 0; n--) {
+        crc = t[0][(crc ^ *p++) & 0xff] ^ (crc >> 8);
+    }
+    return crc;
+}
+
+static u4 crc32cScalar(u4 crc, const u1 *p, size_t n) {
+    return crcSlicing8(CRC32C_TABLES, crc, p, n);
+}
+
+#ifdef JIO_X86
+
+//Произведение многочленов по модулю poly в отражённом представлении
+static constexpr u4 multModP(u4 a, u4 b, u4 poly) {
+    u4 out = 0;
+    for (u4 m = 1u << 31; m != 0; m >>= 1) {
+        if (a & m) {
+            out ^= b;
+        }
+        b = b & 1 ? (b >> 1) ^ poly : b >> 1;
+    }
+    return out;
+}
+
+namespace {
+
+    //Длина каждой из трёх независимо обрабатываемых полос
+    constexpr size_t CRC32C_STRIPE = 1024;
+
+    /**
+     * Таблицы сдвига состояния CRC на <code>bytes</code> нулевых байт,
+     * то есть умножения на x^(8 * bytes).
+     */
+    struct ShiftTables {
+        u4 table[4][256] = {};
+
+        constexpr ShiftTables(u4 poly, size_t bytes) {
+            u4 x = 1u << 31;
+            u4 sq = 1u << 23;
+            for (; bytes != 0; bytes >>= 1) {
+                if (bytes & 1) {
+                    x = multModP(sq, x, poly);
+                }
+                sq = multModP(sq, sq, poly);
+            }
+            for (int k = 0; k < 4; k++) {
+                for (u4 i = 0; i < 256; i++) {
+                    table[k][i] = multModP(x, i << (8 * k), poly);
+                }
+            }
+        }
+
+        inline u4 shift(u4 crc) const {
+            return table[0][crc & 0xff] ^ table[1][(crc >> 8) & 0xff]
+                    ^ table[2][(crc >> 16) & 0xff] ^ table[3][crc >> 24];
+        }
+    };
+
+    constexpr ShiftTables CRC32C_SHIFT(CRC32C_POLY, CRC32C_STRIPE);
+}
+
+__attribute__((target("sse4.2")))
+static u4 crc32cSSE42(u4 crc, const u1 *p, size_t n) {
+    for (; n > 0 && (uintptr_t(p) & 7) != 0; n--) {
+        crc = _mm_crc32_u8(crc, *p++);
+    }
+#ifdef __x86_64__
+    //Три полосы скрывают задержку инструкции crc32
+    for (; n >= 3 * CRC32C_STRIPE; n -= 3 * CRC32C_STRIPE) {
+        u8 c0 = crc, c1 = 0, c2 = 0;
+        for (size_t i = 0; i < CRC32C_STRIPE; i += 8) {
+            c0 = _mm_crc32_u64(c0, read64(p + i));
+            c1 = _mm_crc32_u64(c1, read64(p + CRC32C_STRIPE + i));
+            c2 = _mm_crc32_u64(c2, read64(p + 2 * CRC32C_STRIPE + i));
+        }
+        crc = CRC32C_SHIFT.shift(CRC32C_SHIFT.shift(u4(c0)) ^ u4(c1)) ^ u4(c2);
+        p += 3 * CRC32C_STRIPE;
+    }
+    u8 c = crc;
+    for (; n >= 8; n -= 8, p += 8) {
+        c = _mm_crc32_u64(c, read64(p));
+    }
+    crc = u4(c);
+#endif
+    for (; n >= 4; n -= 4, p += 4) {
+        crc = _mm_crc32_u32(crc, read32(p));
+    }
+    for (; n > 0; n--) {
+        crc = _mm_crc32_u8(crc, *p++);
+    }
+    return crc;
+}
+
+__attribute__((target("pclmul,sse2")))
+static inline __m128i fold(__m128i x, __m128i k) {
+    return _mm_xor_si128(_mm_clmulepi64_si128(x, k, 0x00),
+            _mm_clmulepi64_si128(x, k, 0x11));
+}
+
+/**
+ * Свёртка CRC32 на PCLMULQDQ (Intel, "Fast CRC Computation for Generic
+ * Polynomials Using PCLMULQDQ Instruction"). Требует n >= 64 и обрабатывает
+ * n - n % 16 байт, возвращая их количество в <code>done</code>.
+ */
+__attribute__((target("pclmul,sse2")))
+static u4 crc32PCLMUL(u4 crc, const u1 *p, size_t n, size_t &done) {
+    const __m128i k1k2 = _mm_set_epi64x(0x1c6e41596, 0x154442bd4);
+    const __m128i k3k4 = _mm_set_epi64x(0x0ccaa009e, 0x1751997d0);
+    const __m128i k5 = _mm_set_epi64x(0, 0x163cd6124);
+    const __m128i poly = _mm_set_epi64x(0x1f7011641, 0x1db710641);
+    const __m128i mask32 = _mm_set_epi32(0, 0, 0, -1);
+    const __m128i *in = reinterpret_cast<const __m128i*> (p);
+
+    __m128i x1 = _mm_xor_si128(_mm_loadu_si128(in), _mm_cvtsi32_si128(crc));
+    __m128i x2 = _mm_loadu_si128(in + 1);
+    __m128i x3 = _mm_loadu_si128(in + 2);
+    __m128i x4 = _mm_loadu_si128(in + 3);
+    in += 4;
+    size_t blocks = n / 16 - 4;
+    for (; blocks >= 4; blocks -= 4, in += 4) {
+        x1 = _mm_xor_si128(fold(x1, k1k2), _mm_loadu_si128(in));
+        x2 = _mm_xor_si128(fold(x2, k1k2), _mm_loadu_si128(in + 1));
+        x3 = _mm_xor_si128(fold(x3, k1k2), _mm_loadu_si128(in + 2));
+        x4 = _mm_xor_si128(fold(x4, k1k2), _mm_loadu_si128(in + 3));
+    }
+    x1 = _mm_xor_si128(fold(x1, k3k4), x2);
+    x1 = _mm_xor_si128(fold(x1, k3k4), x3);
+    x1 = _mm_xor_si128(fold(x1, k3k4), x4);
+    for (; blocks > 0; blocks--, in++) {
+        x1 = _mm_xor_si128(fold(x1, k3k4), _mm_loadu_si128(in));
+    }
+    done = reinterpret_cast<const u1*> (in) - p;
+
+    //128 -> 64 бита
+    x1 = _mm_xor_si128(_mm_srli_si128(x1, 8),
+            _mm_clmulepi64_si128(k3k4, x1, 0x01));
+    //64 -> 32 бита
+    x2 = _mm_clmulepi64_si128(_mm_and_si128(x1, mask32), k5, 0x00);
+    x1 = _mm_xor_si128(_mm_srli_si128(x1, 4), x2);
+    //Редукция Барретта
+    x2 = _mm_clmulepi64_si128(_mm_and_si128(x1, mask32), poly, 0x10);
+    x2 = _mm_clmulepi64_si128(_mm_and_si128(x2, mask32), poly, 0x00);
+    x1 = _mm_xor_si128(x1, x2);
+    return _mm_cvtsi128_si32(_mm_srli_si128(x1, 4));
+}
+
+#endif
+
+typedef u4(*crc_kernel)(u4, const u1*, size_t);
+
+static crc_kernel selectCRC32CKernel() {
+#ifdef JIO_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("sse4.2")) {
+        return crc32cSSE42;
+    }
+#endif
+    return crc32cScalar;
+}
+
+static bool hasPCLMUL() {
+#ifdef JIO_X86
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("pclmul") && __builtin_cpu_supports("sse2");
+#else
+    return false;
+#endif
+}
+
+static const crc_kernel CRC32C_KERNEL = selectCRC32CKernel();
+static const bool HAS_PCLMUL = hasPCLMUL();
+
+u4 JIO::crc32c(u4 crc, const void *data, size_t length) {
+    //До динамической инициализации CRC32C_KERNEL равен nullptr
+    crc_kernel kernel = CRC32C_KERNEL != nullptr ? CRC32C_KERNEL : crc32cScalar;
+    return ~kernel(~crc, reinterpret_cast<const u1*> (data), length);
+}
+
+u4 JIO::crc32(u4 crc, const void *data, size_t length) {
+    const u1 *p = reinterpret_cast<const u1*> (data);
+    crc = ~crc;
+#ifdef JIO_X86
+    if (HAS_PCLMUL && length >= 64) {
+        size_t done;
+        crc = crc32PCLMUL(crc, p, length, done);
+        p += done;
+        length -= done;
+    }
+#endif
+    return ~crcSlicing8(CRC32_TABLES, crc, p, length);
+}
+
+constexpr u8 PRIME64_1 = 0x9E3779B185EBCA87ULL;
+constexpr u8 PRIME64_2 = 0xC2B2AE3D27D4EB4FULL;
+constexpr u8 PRIME64_3 = 0x165667B19E3779F9ULL;
+constexpr u8 PRIME64_4 = 0x85EBCA77C2B2AE63ULL;
+constexpr u8 PRIME64_5 = 0x27D4EB2F165667C5ULL;
+
+static inline u8 rotl64(u8 x, int r) {
+    return (x << r) | (x >> (64 - r));
+}
+
+static inline u8 round64(u8 acc, u8 input) {
+    acc += input * PRIME64_2;
+    return rotl64(acc, 31) * PRIME64_1;
+}
+
+static inline u8 merge64(u8 acc, u8 value) {
+    acc ^= round64(0, value);
+    return acc * PRIME64_1 + PRIME64_4;
+}
+
+static inline void initState(u8 v[4], u8 seed) {
+    v[0] = seed + PRIME64_1 + PRIME64_2;
+    v[1] = seed + PRIME64_2;
+    v[2] = seed;
+    v[3] = seed - PRIME64_1;
+}
+
+//Обрабатывает полосы по 32 байта и возвращает указатель на остаток
+static inline const u1* consume(u8 v[4], const u1 *p, const u1 *end) {
+    u8 v1 = v[0], v2 = v[1], v3 = v[2], v4 = v[3];
+    for (; end - p >= 32; p += 32) {
+        v1 = round64(v1, read64(p));
+        v2 = round64(v2, read64(p + 8));
+        v3 = round64(v3, read64(p + 16));
+        v4 = round64(v4, read64(p + 24));
+    }
+    v[0] = v1, v[1] = v2, v[2] = v3, v[3] = v4;
+    return p;
+}
+
+static inline u8 converge(const u8 v[4]) {
+    u8 h = rotl64(v[0], 1) + rotl64(v[1], 7) + rotl64(v[2], 12) + rotl64(v[3], 18);
+    for (int i = 0; i < 4; i++) {
+        h = merge64(h, v[i]);
+    }
+    return h;
+}
+
+static u8 finish(u8 h, const u1 *p, const u1 *end) {
+    for (; end - p >= 8; p += 8) {
+        h ^= round64(0, read64(p));
+        h = rotl64(h, 27) * PRIME64_1 + PRIME64_4;
+    }
+    if (end - p >= 4) {
+        h ^= u8(read32(p)) * PRIME64_1;
+        h = rotl64(h, 23) * PRIME64_2 + PRIME64_3;
+        p += 4;
+    }
+    for (; p < end; p++) {
+        h ^= (*p) * PRIME64_5;
+        h = rotl64(h, 11) * PRIME64_1;
+    }
+    h ^= h >> 33;
+    h *= PRIME64_2;
+    h ^= h >> 29;
+    h *= PRIME64_3;
+    h ^= h >> 32;
+    return h;
+}
+
+u8 JIO::xxHash64(const void *data, size_t length, u8 seed) {
+    const u1 *p = reinterpret_cast<const u1*> (data);
+    const u1 *end = p + length;
+    u8 h;
+    if (length >= 32) {
+        u8 v[4];
+        initState(v, seed);
+        p = consume(v, p, end);
+        h = converge(v);
+    } else {
+        h = seed + PRIME64_5;
+    }
+    return finish(h + length, p, end);
+}
+
+XXHash64::XXHash64(u8 seed) : seed(seed) {
+    reset();
+}
+
+void XXHash64::reset() {
+    initState(v, seed);
+    total = 0;
+    memSize = 0;
+}
+
+void XXHash64::update(const void *data, size_t length) {
+    const u1 *p = reinterpret_cast<const u1*> (data);
+    const u1 *end = p + length;
+    total += length;
+
+    if (memSize + length < 32) {
+        std::memcpy(mem + memSize, p, length);
+        memSize += length;
+        return;
+    }
+    if (memSize != 0) {
+        size_t fill = 32 - memSize;
+        std::memcpy(mem + memSize, p, fill);
+        consume(v, mem, mem + 32);
+        p += fill;
+        memSize = 0;
+    }
+    p = consume(v, p, end);
+    memSize = end - p;
+    std::memcpy(mem, p, memSize);
+}
+
+u8 XXHash64::getValue() const {
+    u8 h;
+    if (total >= 32) {
+        h = converge(v);
+    } else {
+        h = seed + PRIME64_5;
+    }
+    return finish(h + total, mem, mem + memSize);
+}
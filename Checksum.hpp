@@ -0,0 +1,114 @@
+#ifndef CHECKSUM_HPP
+#define CHECKSUM_HPP
+
+#include <cstddef>
+#include "jtypes.hpp"
+
+namespace JIO {
+
+    /**
+     * Значение CRC32C (полином Кастаньоли) после обработки
+     * <code>length</code> байт, начиная со значения <code>crc</code>
+     * (0 для новых данных). Используется инструкция crc32 из SSE4.2,
+     * если процессор её поддерживает, иначе таблицы slicing-by-8.
+     */
+    u4 crc32c(u4 crc, const void *data, size_t length);
+
+    /**
+     * Значение CRC32 (как в zlib и gzip). Используется свёртка
+     * на PCLMULQDQ, если процессор её поддерживает.
+     */
+    u4 crc32(u4 crc, const void *data, size_t length);
+
+    /**
+     * Некриптографический 64-битный хэш xxHash64.
+     */
+    u8 xxHash64(const void *data, size_t length, u8 seed);
+
+    /**
+     * Контрольная сумма, вычисляемая по мере поступления данных.
+     */
+    class Checksum {
+    public:
+        virtual void update(const void *data, size_t length) = 0;
+
+        inline void update(u1 byte) {
+            update(&byte, 1);
+        }
+
+        virtual u8 getValue() const = 0;
+        virtual void reset() = 0;
+
+        inline virtual ~Checksum() { }
+    };
+
+    class CRC32C final : public Checksum {
+    public:
+
+        inline CRC32C() : crc(0) { }
+
+        using Checksum::update;
+
+        inline virtual void update(const void *data, size_t length) override {
+            crc = crc32c(crc, data, length);
+        }
+
+        inline virtual u8 getValue() const override {
+            return crc;
+        }
+
+        inline virtual void reset() override {
+            crc = 0;
+        }
+    private:
+        u4 crc;
+    };
+
+    class CRC32 final : public Checksum {
+    public:
+
+        inline CRC32() : crc(0) { }
+
+        using Checksum::update;
+
+        inline virtual void update(const void *data, size_t length) override {
+            crc = crc32(crc, data, length);
+        }
+
+        inline virtual u8 getValue() const override {
+            return crc;
+        }
+
+        inline virtual void reset() override {
+            crc = 0;
+        }
+    private:
+        u4 crc;
+    };
+
+    /**
+     * Потоковое вычисление xxHash64. Результат совпадает с
+     * <code>xxHash64</code> для всех данных, переданных после
+     * последнего <code>reset()</code>.
+     */
+    class XXHash64 final : public Checksum {
+    public:
+        XXHash64(u8 seed);
+
+        inline XXHash64() : XXHash64(0) { }
+
+        using Checksum::update;
+        virtual void update(const void *data, size_t length) override;
+        virtual u8 getValue() const override;
+        virtual void reset() override;
+    private:
+        const u8 seed;
+        u8 v[4];
+        u8 total;
+        u1 mem[32];
+        size_t memSize;
+    };
+}
+
+#endif /* CHECKSUM_HPP */
+
@@ -0,0 +1,119 @@
+#ifndef CHECKSUMSTREAMS_HPP
+#define CHECKSUMSTREAMS_HPP
+
+#include "Checksum.hpp"
+#include "Streams.hpp"
+
+namespace JIO {
+
+    /**
+     * Обновляет контрольную сумму всеми байтами, прочитанными из исходного
+     * потока, в том же проходе, что и чтение. Пропущенные байты также
+     * читаются и учитываются.
+     */
+    class ChecksumInputStream final : public InputStream {
+    public:
+
+        inline ChecksumInputStream(InputStream &in, Checksum &checksum) :
+        in(in), checksum(checksum) { }
+
+        using InputStream::read;
+        using InputStream::borrow;
+
+        inline virtual int read() override {
+            int out = in.read();
+            if (out >= 0) {
+                checksum.update(u1(out));
+            }
+            return out;
+        }
+
+        inline virtual s8 read(void *buf, s8 offset, s8 length) override {
+            s8 out = in.read(buf, offset, length);
+            if (out > 0) {
+                checksum.update(reinterpret_cast<u1*> (buf) + offset, out);
+            }
+            return out;
+        }
+
+        inline virtual s8 available() override {
+            return in.available();
+        }
+
+        inline virtual const u1* peek(s8 length) override {
+            return in.peek(length);
+        }
+
+        inline virtual const u1* borrow(s8 length) override {
+            const u1 *out = in.borrow(length);
+            if (out != nullptr) {
+                checksum.update(out, length);
+            }
+            return out;
+        }
+
+        inline Checksum& getChecksum() const {
+            return checksum;
+        }
+
+        inline virtual ~ChecksumInputStream() override { }
+    private:
+        InputStream &in;
+        Checksum &checksum;
+
+        ChecksumInputStream(const ChecksumInputStream&);
+        ChecksumInputStream& operator=(const ChecksumInputStream&);
+    };
+
+    /**
+     * Обновляет контрольную сумму всеми байтами, записанными в исходный
+     * поток.
+     */
+    class ChecksumOutputStream final : public OutputStream {
+    public:
+
+        inline ChecksumOutputStream(OutputStream &out, Checksum &checksum) :
+        out(out), checksum(checksum) { }
+
+        using OutputStream::write;
+        using OutputStream::writev;
+
+        inline virtual void write(u1 byte) override {
+            out.write(byte);
+            checksum.update(byte);
+        }
+
+        inline virtual void write(const void *buf, s8 offset, s8 length) override {
+            const u1 *data = checkSBounds<const u1*>(buf, offset, length);
+            out.write(data, 0, length);
+            checksum.update(data, length);
+        }
+
+        inline virtual void writev(const WriteSegment *segments, s8 count) override {
+            checkSegments(segments, count);
+            out.writev(segments, count);
+            for (s8 i = 0; i < count; i++) {
+                checksum.update(segments[i].data, segments[i].length);
+            }
+        }
+
+        inline virtual void flush() override {
+            out.flush();
+        }
+
+        inline Checksum& getChecksum() const {
+            return checksum;
+        }
+
+        inline virtual ~ChecksumOutputStream() override { }
+    private:
+        OutputStream &out;
+        Checksum &checksum;
+
+        ChecksumOutputStream(const ChecksumOutputStream&);
+        ChecksumOutputStream& operator=(const ChecksumOutputStream&);
+    };
+}
+
+#endif /* CHECKSUMSTREAMS_HPP */
+
@@ -0,0 +1,176 @@
+#ifndef COMPOSITEBYTEBUFFER_HPP
+#define COMPOSITEBYTEBUFFER_HPP
+
+#include <algorithm>
+#include <initializer_list>
+#include <vector>
+#include "ByteBuffer.hpp"
+#include "Streams.hpp"
+
+namespace JIO {
+
+    /**
+     * Упорядоченный набор срезов ByteBuffer, доступный как единый буфер.
+     * Объединение, добавление заголовков и срезы не копируют данные.
+     */
+    class CompositeByteBuffer {
+    private:
+        std::vector<ByteBuffer<false>> segments;
+        //Смещение начала каждого сегмента
+        std::vector<size_t> offsets;
+        size_t _capacity;
+
+        inline size_t findSegment(size_t index) const {
+            return std::upper_bound(offsets.begin(), offsets.end(), index)
+                    - offsets.begin() - 1;
+        }
+
+        //Проверяет все сегменты, которые затронет запись
+        inline void checkWritable(size_t index, size_t length) const {
+            checkRange(index, length, _capacity);
+            if (length == 0) {
+                return;
+            }
+            for (size_t i = findSegment(index);
+                    i < segments.size() && offsets[i] < index + length; i++) {
+                if (segments[i].isReadOnly()) {
+                    throw ReadOnlyBufferException();
+                }
+            }
+        }
+
+        template<typename F>
+        inline void forRange(size_t index, size_t length, F f) const {
+            checkRange(index, length, _capacity);
+            if (length == 0) {
+                return;
+            }
+            size_t done = 0;
+            for (size_t i = findSegment(index); done < length; i++) {
+                const ByteBuffer<false> &seg = segments[i];
+                size_t from = index + done - offsets[i];
+                size_t n = std::min(seg.capacity() - from, length - done);
+                f(seg.getData() + from, done, n);
+                done += n;
+            }
+        }
+    public:
+
+        inline CompositeByteBuffer() : _capacity(0) { }
+
+        inline CompositeByteBuffer(std::initializer_list<ByteBuffer<false>> list) :
+        _capacity(0) {
+            for (const ByteBuffer<false> &buf : list) {
+                append(buf);
+            }
+        }
+
+        inline size_t capacity() const {
+            return _capacity;
+        }
+
+        inline size_t segmentCount() const {
+            return segments.size();
+        }
+
+        inline const ByteBuffer<false>& segment(size_t index) const {
+            return segments.at(index);
+        }
+
+        inline void append(const ByteBuffer<false> &buf) {
+            if (buf.capacity() == 0) {
+                return;
+            }
+            segments.push_back(buf);
+            offsets.push_back(_capacity);
+            _capacity += buf.capacity();
+        }
+
+        inline void append(const CompositeByteBuffer &other) {
+            for (const ByteBuffer<false> &buf : other.segments) {
+                append(buf);
+            }
+        }
+
+        inline void prepend(const ByteBuffer<false> &buf) {
+            size_t length = buf.capacity();
+            if (length == 0) {
+                return;
+            }
+            segments.insert(segments.begin(), buf);
+            for (size_t &offset : offsets) {
+                offset += length;
+            }
+            offsets.insert(offsets.begin(), 0);
+            _capacity += length;
+        }
+
+        inline void clear() {
+            segments.clear();
+            offsets.clear();
+            _capacity = 0;
+        }
+
+        inline void get(size_t index, void *dst, size_t length) const {
+            char *out = reinterpret_cast<char*> (dst);
+            forRange(index, length, [out](char *data, size_t done, size_t n) {
+                std::memmove(out + done, data, n);
+            });
+        }
+
+        /**
+         * Если диапазон задевает сегмент только для чтения, бросает
+         * ReadOnlyBufferException, ничего не записав.
+         */
+        inline void put(size_t index, const void *src, size_t length) {
+            checkWritable(index, length);
+            const char *in = reinterpret_cast<const char*> (src);
+            forRange(index, length, [in](char *data, size_t done, size_t n) {
+                std::memmove(data, in + done, n);
+            });
+        }
+
+        template<typename T>
+        inline void getObject(size_t index, T &obj) const {
+            get(index, &obj, sizeof (T));
+        }
+
+        template<typename T>
+        inline void putObject(size_t index, const T &obj) {
+            put(index, &obj, sizeof (T));
+        }
+
+        inline CompositeByteBuffer slice(size_t index, size_t length) const {
+            CompositeByteBuffer out;
+            forRange(index, length, [&](char*, size_t done, size_t n) {
+                size_t seg = findSegment(index + done);
+                out.append(segments[seg].slice(index + done - offsets[seg], n));
+            });
+            return out;
+        }
+
+        /**
+         * Возвращает содержимое в виде одного ByteBuffer. Если сегмент
+         * один, он возвращается без копирования.
+         */
+        inline ByteBuffer<false> flatten() const {
+            if (segments.size() == 1) {
+                return segments[0];
+            }
+            ByteBuffer<false> out(_capacity);
+            get(0, out.getData(), _capacity);
+            return out;
+        }
+
+        /**
+         * Записывает все сегменты одним векторным вызовом.
+         */
+        inline void writeTo(OutputStream &out) const {
+            std::vector<WriteSegment> list(segments.begin(), segments.end());
+            out.writev(list.data(), list.size());
+        }
+    };
+}
+
+#endif /* COMPOSITEBYTEBUFFER_HPP */
+
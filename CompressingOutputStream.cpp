@@ -0,0 +1,110 @@
+#include "CompressionStreams.hpp"
+#include "LZ4.hpp"
+
+using namespace JIO;
+
+static const u1 MAGIC[4] = {'J', 'L', 'Z', '4'};
+constexpr u1 FLAG_CHECKSUM = 1;
+constexpr u4 RAW_BLOCK_FLAG = 0x80000000;
+constexpr s8 MAX_BLOCK_SIZE = 64 * 1024 * 1024;
+
+static inline void putLE(u1 *dst, u4 value) {
+    dst[0] = u1(value);
+    dst[1] = u1(value >> 8);
+    dst[2] = u1(value >> 16);
+    dst[3] = u1(value >> 24);
+}
+
+CompressingOutputStream::CompressingOutputStream(OutputStream &output,
+        s8 blockSize, bool check) :
+out(output),
+size(blockSize),
+checksum(check),
+buf(),
+compressed(),
+count(0),
+finished(false) {
+    if (blockSize <= 0 || blockSize > MAX_BLOCK_SIZE) {
+        throw IllegalArgumentException("Illegal block size: ", blockSize);
+    }
+    buf.reset(new u1[blockSize]);
+    compressed.reset(new u1[lz4CompressBound(blockSize) + 8]);
+
+    u1 header[9];
+    std::memcpy(header, MAGIC, 4);
+    header[4] = checksum ? FLAG_CHECKSUM : 0;
+    putLE(header + 5, u4(blockSize));
+    out.write(header, 0, sizeof (header));
+}
+
+void CompressingOutputStream::writeBlock() {
+    if (finished) {
+        throw IOException("Stream finished");
+    }
+    if (count == 0) {
+        return;
+    }
+
+    u1 *block = compressed.get();
+    size_t length = lz4Compress(buf.get(), count,
+            block + 4, lz4CompressBound(size) + 4);
+    if (length >= size_t(count)) {
+        //Несжимаемые данные записываются как есть
+        putLE(block, u4(count) | RAW_BLOCK_FLAG);
+        std::memcpy(block + 4, buf.get(), count);
+        length = count;
+    } else {
+        putLE(block, u4(length));
+    }
+    length += 4;
+    if (checksum) {
+        putLE(block + length, xxHash32(buf.get(), count, 0));
+        length += 4;
+    }
+    count = 0;
+    out.write(block, 0, length);
+}
+
+void CompressingOutputStream::write(const void *b, s8 offset, s8 length) {
+    if (finished) {
+        throw IOException("Stream finished");
+    }
+    const u1 *data = checkSBounds<const u1*>(b, offset, length);
+    while (length > 0) {
+        if (count >= size) {
+            writeBlock();
+        }
+        s8 n = std::min(length, size - count);
+        std::memcpy(buf.get() + count, data, n);
+        count += n;
+        data += n;
+        length -= n;
+    }
+}
+
+void CompressingOutputStream::flush() {
+    //После finish() данных в буфере нет
+    if (!finished) {
+        writeBlock();
+    }
+    out.flush();
+}
+
+void CompressingOutputStream::finish() {
+    if (finished) {
+        return;
+    }
+    writeBlock();
+    finished = true;
+    u1 end[4] = {};
+    out.write(end, 0, 4);
+    out.flush();
+}
+
+CompressingOutputStream::~CompressingOutputStream() {
+    try {
+        finish();
+    } catch (...) {
+        //Деструктор не должен бросать исключения
+    }
+}
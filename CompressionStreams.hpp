@@ -0,0 +1,116 @@
+#ifndef COMPRESSIONSTREAMS_HPP
+#define COMPRESSIONSTREAMS_HPP
+
+#include <cstring>
+#include <memory>
+#include "Streams.hpp"
+
+namespace JIO {
+
+    constexpr const s8 DEFAULT_COMPRESSION_BLOCK_SIZE = 64 * 1024;
+
+    /**
+     * Сжимающий поток. Данные делятся на блоки размера
+     * <code>blockSize</code>, каждый блок сжимается в формате LZ4 block.
+     * Формат потока: заголовок (сигнатура "JLZ4", флаги, размер блока),
+     * затем блоки (u4 LE длина, старший бит которой означает несжатый
+     * блок, данные и, если включено, xxHash32 исходных данных), в конце
+     * нулевая длина. Конец потока записывается в <code>finish()</code>
+     * или в деструкторе.
+     */
+    class CompressingOutputStream final : public OutputStream {
+    public:
+        CompressingOutputStream(OutputStream &out, s8 blockSize, bool checksum);
+
+        inline CompressingOutputStream(OutputStream &out) :
+        CompressingOutputStream(out, DEFAULT_COMPRESSION_BLOCK_SIZE, false) { }
+
+        using OutputStream::write;
+
+        inline virtual void write(u1 byte) override {
+            if (finished) {
+                throw IOException("Stream finished");
+            }
+            if (count >= size) {
+                writeBlock();
+            }
+            buf[count++] = byte;
+        }
+
+        virtual void write(const void *buf, s8 offset, s8 length) override;
+
+        /**
+         * Сжимает накопленные данные в отдельный блок и сбрасывает
+         * исходный поток. Частые вызовы ухудшают степень сжатия.
+         */
+        virtual void flush() override;
+
+        /**
+         * Записывает оставшиеся данные и конец потока. Последующая запись
+         * бросает IOException.
+         */
+        void finish();
+
+        virtual ~CompressingOutputStream() override;
+    private:
+        OutputStream &out;
+        const s8 size;
+        const bool checksum;
+        std::unique_ptr<u1[]> buf;
+        std::unique_ptr<u1[]> compressed;
+        s8 count;
+        bool finished;
+
+        void writeBlock();
+
+        CompressingOutputStream(const CompressingOutputStream&);
+        CompressingOutputStream& operator=(const CompressingOutputStream&);
+    };
+
+    /**
+     * Распаковывает поток, записанный <code>CompressingOutputStream</code>.
+     * При повреждённых данных или несовпадении контрольной суммы бросается
+     * IOException.
+     */
+    class DecompressingInputStream final : public InputStream {
+    public:
+        DecompressingInputStream(InputStream &in);
+
+        using InputStream::read;
+
+        inline virtual int read() override {
+            if (position < count) {
+                return buf[position++];
+            }
+            if (!nextBlock()) {
+                return -1;
+            }
+            return buf[position++];
+        }
+
+        virtual s8 read(void *buf, s8 offset, s8 length) override;
+        virtual s8 available() override;
+
+        inline virtual ~DecompressingInputStream() override { }
+    private:
+        InputStream &in;
+        s8 size;
+        bool checksum;
+        bool started;
+        bool eof;
+        std::unique_ptr<u1[]> buf;
+        std::unique_ptr<u1[]> compressed;
+        s8 position;
+        s8 count;
+
+        void readHeader();
+        s8 readBlock(u1 *dst);
+        bool nextBlock();
+
+        DecompressingInputStream(const DecompressingInputStream&);
+        DecompressingInputStream& operator=(const DecompressingInputStream&);
+    };
+}
+
+#endif /* COMPRESSIONSTREAMS_HPP */
+
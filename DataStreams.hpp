@@ -0,0 +1,224 @@
+#ifndef DATASTREAMS_HPP
+#define DATASTREAMS_HPP
+
+#include "Streams.hpp"
+#include "ByteOrder.hpp"
+#include "Varint.hpp"
+
+namespace JIO {
+
+    /**
+     * Чтение примитивных типов из <code>InputStream</code> в порядке байт
+     * <code>order</code>. Каждое значение читается через
+     * <code>readFully</code>, поэтому исходный поток стоит буферизировать.
+     */
+    template<ByteOrder order = ByteOrder::BIG>
+    class DataInputStream : public InputStream {
+    public:
+
+        inline DataInputStream(InputStream &in) : in(in) { }
+
+        using InputStream::read;
+        using InputStream::transferTo;
+
+        inline virtual int read() override {
+            return in.read();
+        }
+
+        inline virtual s8 read(void *buf, s8 offset, s8 length) override {
+            return in.read(buf, offset, length);
+        }
+
+        inline virtual s8 skip(s8 count) override {
+            return in.skip(count);
+        }
+
+        inline virtual s8 available() override {
+            return in.available();
+        }
+
+        inline virtual s8 transferTo(OutputStream &out, s8 max) override {
+            return in.transferTo(out, max);
+        }
+
+        template<typename T>
+        inline T readPrimitive() {
+            T out;
+            readFully(&out, sizeof (T));
+            return convertOrder<order>(out);
+        }
+
+        inline bool readBoolean() {
+            return readPrimitive<u1>() != 0;
+        }
+
+        inline s1 readByte() {
+            return readPrimitive<s1>();
+        }
+
+        inline u1 readUnsignedByte() {
+            return readPrimitive<u1>();
+        }
+
+        inline s2 readShort() {
+            return readPrimitive<s2>();
+        }
+
+        inline u2 readUnsignedShort() {
+            return readPrimitive<u2>();
+        }
+
+        inline u2 readChar() {
+            return readPrimitive<u2>();
+        }
+
+        inline s4 readInt() {
+            return readPrimitive<s4>();
+        }
+
+        inline s8 readLong() {
+            return readPrimitive<s8>();
+        }
+
+        inline f4 readFloat() {
+            return readPrimitive<f4>();
+        }
+
+        inline f8 readDouble() {
+            return readPrimitive<f8>();
+        }
+
+        inline u8 readVarint() {
+            u8 out = 0;
+            for (unsigned shift = 0; shift < 64; shift += 7) {
+                int b = read();
+                if (b < 0) {
+                    throw EOFException("Truncated varint");
+                }
+                out |= u8(b & 0x7f) << shift;
+                if ((b & 0x80) == 0) {
+                    if (!isVarintEnd(u1(b), shift)) {
+                        break;
+                    }
+                    return out;
+                }
+            }
+            throw IOException("Malformed varint");
+        }
+
+        inline s8 readSignedVarint() {
+            return zigZagDecode(readVarint());
+        }
+
+        /**
+         * Читает <code>count</code> элементов и меняет порядок байт сразу
+         * во всём массиве.
+         */
+        template<typename T>
+        inline void readArray(T *data, size_t count) {
+            readObjects<order>(data, count);
+        }
+
+        inline virtual ~DataInputStream() override { }
+    private:
+        InputStream &in;
+        DataInputStream(const DataInputStream&);
+        DataInputStream& operator=(const DataInputStream&);
+    };
+
+    /**
+     * Запись примитивных типов в <code>OutputStream</code> в порядке байт
+     * <code>order</code>.
+     */
+    template<ByteOrder order = ByteOrder::BIG>
+    class DataOutputStream : public OutputStream {
+    public:
+
+        inline DataOutputStream(OutputStream &out) : out(out) { }
+
+        using OutputStream::write;
+        using OutputStream::writev;
+
+        inline virtual void write(u1 byte) override {
+            out.write(byte);
+        }
+
+        inline virtual void write(const void *buf, s8 offset, s8 length) override {
+            out.write(buf, offset, length);
+        }
+
+        inline virtual void writev(const WriteSegment *segments, s8 count) override {
+            out.writev(segments, count);
+        }
+
+        inline virtual void flush() override {
+            out.flush();
+        }
+
+        template<typename T>
+        inline void writePrimitive(T value) {
+            T tmp = convertOrder<order>(value);
+            write(&tmp, 0, sizeof (T));
+        }
+
+        inline void writeBoolean(bool value) {
+            writePrimitive<u1>(value ? 1 : 0);
+        }
+
+        inline void writeByte(s1 value) {
+            writePrimitive(value);
+        }
+
+        inline void writeShort(s2 value) {
+            writePrimitive(value);
+        }
+
+        inline void writeChar(u2 value) {
+            writePrimitive(value);
+        }
+
+        inline void writeInt(s4 value) {
+            writePrimitive(value);
+        }
+
+        inline void writeLong(s8 value) {
+            writePrimitive(value);
+        }
+
+        inline void writeFloat(f4 value) {
+            writePrimitive(value);
+        }
+
+        inline void writeDouble(f8 value) {
+            writePrimitive(value);
+        }
+
+        inline void writeVarint(u8 value) {
+            u1 tmp[MAX_VARINT_LENGTH];
+            write(tmp, 0, encodeVarint(value, tmp));
+        }
+
+        inline void writeSignedVarint(s8 value) {
+            writeVarint(zigZagEncode(value));
+        }
+
+        /**
+         * Записывает <code>count</code> элементов. При несовпадении порядка
+         * байт с порядком платформы массив преобразуется блоками через
+         * промежуточный буфер.
+         */
+        template<typename T>
+        inline void writeArray(const T *data, size_t count) {
+            writeObjects<order>(data, count);
+        }
+
+        inline virtual ~DataOutputStream() override { }
+    private:
+        OutputStream &out;
+        DataOutputStream(const DataOutputStream&);
+        DataOutputStream& operator=(const DataOutputStream&);
+    };
+}
+
+#endif /* DATASTREAMS_HPP */
+
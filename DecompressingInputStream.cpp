@@ -0,0 +1,135 @@
+#include "CompressionStreams.hpp"
+#include "LZ4.hpp"
+
+using namespace JIO;
+
+static const u1 MAGIC[4] = {'J', 'L', 'Z', '4'};
+constexpr u1 FLAG_CHECKSUM = 1;
+constexpr u4 RAW_BLOCK_FLAG = 0x80000000;
+constexpr s8 MAX_BLOCK_SIZE = 64 * 1024 * 1024;
+
+static inline u4 getLE(const u1 *src) {
+    return u4(src[0]) | (u4(src[1]) << 8)
+            | (u4(src[2]) << 16) | (u4(src[3]) << 24);
+}
+
+DecompressingInputStream::DecompressingInputStream(InputStream &input) :
+in(input),
+size(0),
+checksum(false),
+started(false),
+eof(false),
+buf(),
+compressed(),
+position(0),
+count(0) { }
+
+void DecompressingInputStream::readHeader() {
+    u1 header[9];
+    in.readFully(header, sizeof (header));
+    if (std::memcmp(header, MAGIC, 4) != 0) {
+        throw IOException("Wrong compressed stream signature");
+    }
+    if ((header[4] & ~FLAG_CHECKSUM) != 0) {
+        throw IOException("Unknown compressed stream flags: ", int(header[4]));
+    }
+    checksum = header[4] & FLAG_CHECKSUM;
+    size = getLE(header + 5);
+    if (size <= 0 || size > MAX_BLOCK_SIZE) {
+        throw IOException("Illegal block size: ", size);
+    }
+    buf.reset(new u1[size]);
+    compressed.reset(new u1[size]);
+    started = true;
+}
+
+s8 DecompressingInputStream::readBlock(u1 *dst) {
+    if (eof) {
+        return -1;
+    }
+
+    u1 tmp[4];
+    in.readFully(tmp, 4);
+    u4 header = getLE(tmp);
+    if (header == 0) {
+        eof = true;
+        return -1;
+    }
+
+    s8 length = header & ~RAW_BLOCK_FLAG;
+    if (length > size) {
+        throw IOException("Too big block: ", length);
+    }
+    s8 out;
+    if (header & RAW_BLOCK_FLAG) {
+        in.readFully(dst, length);
+        out = length;
+    } else {
+        in.readFully(compressed.get(), length);
+        out = lz4Decompress(compressed.get(), length, dst, size);
+    }
+    if (checksum) {
+        in.readFully(tmp, 4);
+        if (getLE(tmp) != xxHash32(dst, out, 0)) {
+            throw IOException("Block checksum mismatch");
+        }
+    }
+    return out;
+}
+
+bool DecompressingInputStream::nextBlock() {
+    if (!started) {
+        readHeader();
+    }
+    position = 0;
+    count = 0;
+    s8 n;
+    do {
+        n = readBlock(buf.get());
+        if (n < 0) {
+            return false;
+        }
+    } while (n == 0);
+    count = n;
+    return true;
+}
+
+s8 DecompressingInputStream::read(void *b, s8 offset, s8 length) {
+    u1 *data = checkSBounds<u1*>(b, offset, length);
+    if (length == 0) {
+        return 0;
+    }
+
+    s8 n = 0;
+    while (n < length) {
+        s8 avail = count - position;
+        if (avail > 0) {
+            s8 cnt = std::min(avail, length - n);
+            std::memcpy(data + n, buf.get() + position, cnt);
+            position += cnt;
+            n += cnt;
+            continue;
+        }
+        if (n != 0 && in.available() <= 0) {
+            break;
+        }
+        if (!started) {
+            readHeader();
+        }
+        if (length - n >= size) {
+            //Блок распаковывается сразу в буфер пользователя
+            s8 nr = readBlock(data + n);
+            if (nr < 0) {
+                break;
+            }
+            n += nr;
+        } else if (!nextBlock()) {
+            break;
+        }
+    }
+    return n == 0 ? -1 : n;
+}
+
+s8 DecompressingInputStream::available() {
+    return count - position;
+}
@@ -0,0 +1,185 @@
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "FileStreams.hpp"
+
+using namespace JIO;
+
+static s8 checkBufferSize(s8 size) {
+    if (size <= 0 || size % DIRECT_IO_ALIGNMENT != 0) {
+        throw IllegalArgumentException("Buffer size ", size,
+                " is not a positive multiple of ", DIRECT_IO_ALIGNMENT);
+    }
+    return size;
+}
+
+static int openFile(const File &file) {
+    int fd;
+    do {
+        fd = ::open(file.getPath().c_str(), O_RDONLY | O_CLOEXEC | O_DIRECT);
+    } while (fd < 0 && errno == EINTR);
+
+    if (fd < 0) {
+        if (errno == EINVAL) {
+            throw IOException("O_DIRECT is not supported for file: ",
+                    file.getPath().string());
+        }
+        throw IOException("Unable to open file: ", std::strerror(errno));
+    }
+    return fd;
+}
+
+DirectFileInputStream::DirectFileInputStream(const File f, s8 bufsize) :
+file(f),
+size(checkBufferSize(bufsize)),
+buf(reinterpret_cast<u1*> (allocateAligned(bufsize, DIRECT_IO_ALIGNMENT)),
+free_deleter),
+fd(openFile(f)),
+position(0),
+count(0),
+eof(false) { }
+
+s8 DirectFileInputStream::fill() {
+    position = 0;
+    count = 0;
+    if (eof) {
+        return -1;
+    }
+
+    ssize_t out;
+    do {
+        out = ::read(fd, buf.get(), size);
+    } while (out < 0 && errno == EINTR);
+
+    if (out < 0) {
+        throw IOException("Read error: ", std::strerror(errno));
+    }
+    //После неполного блока смещение в файле не выровнено
+    if (out < size) {
+        eof = true;
+    }
+    count = out;
+    return out == 0 ? -1 : out;
+}
+
+int DirectFileInputStream::readSlow() {
+    if (fill() < 0) {
+        return -1;
+    }
+    return buf[position++];
+}
+
+s8 DirectFileInputStream::read(void *b, s8 offset, s8 length) {
+    if (length == 0) {
+        return 0;
+    }
+
+    u1 *data = checkSBounds<u1*>(b, offset, length);
+
+    s8 n = 0;
+    while (n < length) {
+        if (position == count && fill() < 0) {
+            break;
+        }
+        s8 cnt = std::min(count - position, length - n);
+        std::memcpy(data + n, buf.get() + position, cnt);
+        position += cnt;
+        n += cnt;
+    }
+    return n == 0 ? -1 : n;
+}
+
+s8 DirectFileInputStream::skip(s8 n) {
+    if (n <= 0) {
+        return 0;
+    }
+    s8 avail = count - position;
+    if (avail >= n || eof) {
+        avail = std::min(avail, n);
+        position += avail;
+        return avail;
+    }
+    position = count;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        throw IOException("Seek error: ", std::strerror(errno));
+    }
+    off_t pos = lseek(fd, 0, SEEK_CUR);
+    if (pos < 0) {
+        throw IOException("Seek error: ", std::strerror(errno));
+    }
+
+    s8 rest = st.st_size > pos ? st.st_size - pos : 0;
+    u8 target = pos + std::min(rest, n - avail);
+    //Чтение продолжается с начала выровненного блока
+    u8 aligned = target & ~u8(DIRECT_IO_ALIGNMENT - 1);
+    if (lseek(fd, aligned, SEEK_SET) < 0) {
+        throw IOException("Seek error: ", std::strerror(errno));
+    }
+    position = count = 0;
+    if (aligned < target) {
+        fill();
+        position = std::min(s8(target - aligned), count);
+    }
+    return avail + (target - pos);
+}
+
+s8 DirectFileInputStream::available() {
+    s8 avail = count - position;
+    if (eof) {
+        return avail;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        throw IOException("Unable to get available bytes: ",
+                std::strerror(errno));
+    }
+    off_t pos = lseek(fd, 0, SEEK_CUR);
+    if (pos < 0) {
+        throw IOException("Unable to get available bytes: ",
+                std::strerror(errno));
+    }
+    return avail + (st.st_size > pos ? st.st_size - pos : 0);
+}
+
+s8 DirectFileInputStream::transferTo(OutputStream &out, s8 max) {
+    if (max < 0) {
+        throw IllegalArgumentException("max < 0");
+    }
+
+    s8 total = 0;
+    while (total < max) {
+        if (position == count && fill() < 0) {
+            break;
+        }
+        s8 cnt = std::min(count - position, max - total);
+        out.write(buf.get(), position, cnt);
+        position += cnt;
+        total += cnt;
+    }
+    return total;
+}
+
+const u1* DirectFileInputStream::peek(s8 length) {
+    checkLength(length);
+    if (length > count - position) {
+        return nullptr;
+    }
+    return buf.get() + position;
+}
+
+const u1* DirectFileInputStream::borrow(s8 length) {
+    const u1 *out = peek(length);
+    if (out != nullptr) {
+        position += length;
+    }
+    return out;
+}
+
+DirectFileInputStream::~DirectFileInputStream() {
+    ::close(fd);
+}
@@ -0,0 +1,143 @@
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "FileStreams.hpp"
+
+using namespace JIO;
+
+static s8 checkBufferSize(s8 size) {
+    if (size <= 0 || size % DIRECT_IO_ALIGNMENT != 0) {
+        throw IllegalArgumentException("Buffer size ", size,
+                " is not a positive multiple of ", DIRECT_IO_ALIGNMENT);
+    }
+    return size;
+}
+
+static int openFile(const File &file, bool append) {
+    //Запись ведётся по явным смещениям, O_APPEND с O_DIRECT не нужен
+    int flags = O_RDWR | O_CREAT | O_CLOEXEC | O_DIRECT | (append ? 0 : O_TRUNC);
+
+    int fd;
+    do {
+        fd = ::open(file.getPath().c_str(), flags, 0666);
+    } while (fd < 0 && errno == EINTR);
+
+    if (fd < 0) {
+        if (errno == EINVAL) {
+            throw IOException("O_DIRECT is not supported for file: ",
+                    file.getPath().string());
+        }
+        throw IOException("Unable to open file: ", std::strerror(errno));
+    }
+    return fd;
+}
+
+static void writeFully(int fd, const u1 *data, s8 length, u8 position) {
+    while (length > 0) {
+        ssize_t n = ::pwrite(fd, data, length, position);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            throw IOException("Write error: ", std::strerror(errno));
+        }
+        data += n;
+        length -= n;
+        position += n;
+    }
+}
+
+DirectFileOutputStream::DirectFileOutputStream(const File f, bool append,
+        s8 bufsize) :
+file(f),
+size(checkBufferSize(bufsize)),
+buf(reinterpret_cast<u1*> (allocateAligned(bufsize, DIRECT_IO_ALIGNMENT)),
+free_deleter),
+fd(openFile(f, append)),
+count(0),
+filePosition(0) {
+    if (!append) {
+        return;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        int err = errno;
+        ::close(fd);
+        throw IOException("Unable to get file size: ", std::strerror(err));
+    }
+    //Неполный последний блок файла дописывается в буфере
+    filePosition = st.st_size & ~u8(DIRECT_IO_ALIGNMENT - 1);
+    s8 tail = st.st_size - filePosition;
+    if (tail == 0) {
+        return;
+    }
+    ssize_t n;
+    do {
+        n = ::pread(fd, buf.get(), DIRECT_IO_ALIGNMENT, filePosition);
+    } while (n < 0 && errno == EINTR);
+    if (n != tail) {
+        int err = n < 0 ? errno : EIO;
+        ::close(fd);
+        throw IOException("Unable to read file tail: ", std::strerror(err));
+    }
+    count = tail;
+}
+
+void DirectFileOutputStream::writeBlocks() {
+    s8 aligned = count & ~s8(DIRECT_IO_ALIGNMENT - 1);
+    if (aligned == 0) {
+        return;
+    }
+    writeFully(fd, buf.get(), aligned, filePosition);
+    filePosition += aligned;
+    count -= aligned;
+    std::memcpy(buf.get(), buf.get() + aligned, count);
+}
+
+void DirectFileOutputStream::write(const void *b, s8 offset, s8 length) {
+    const u1 *data = checkSBounds<const u1*>(b, offset, length);
+
+    while (length > 0) {
+        if (count == size) {
+            writeBlocks();
+        }
+        s8 cnt = std::min(size - count, length);
+        std::memcpy(buf.get() + count, data, cnt);
+        count += cnt;
+        data += cnt;
+        length -= cnt;
+    }
+}
+
+void DirectFileOutputStream::flush() {
+    writeBlocks();
+    if (count == 0) {
+        return;
+    }
+
+    int flags = fcntl(fd, F_GETFL);
+    if (flags < 0 || fcntl(fd, F_SETFL, flags & ~O_DIRECT) < 0) {
+        throw IOException("Unable to clear O_DIRECT: ", std::strerror(errno));
+    }
+    try {
+        writeFully(fd, buf.get(), count, filePosition);
+    } catch (...) {
+        fcntl(fd, F_SETFL, flags);
+        throw;
+    }
+    if (fcntl(fd, F_SETFL, flags) < 0) {
+        throw IOException("Unable to set O_DIRECT: ", std::strerror(errno));
+    }
+}
+
+DirectFileOutputStream::~DirectFileOutputStream() {
+    try {
+        flush();
+    } catch (...) {
+        //Деструктор не должен бросать исключения
+    }
+    ::close(fd);
+}
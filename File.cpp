@@ -1,3 +1,9 @@
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 #include "File.hpp"
 
 using namespace JIO;
@@ -78,4 +84,62 @@ std::vector<File> File::listFiles() const {
 bool File::remove() const noexcept {
     std::error_code ignore;
     return fs::remove(path, ignore);
-}
\ No newline at end of file
+}
+
+ByteBuffer<false> File::map(MapMode mode, u8 position, u8 size) const {
+    if ((position + size) < position || size > POINTER_MASK) {
+        throw IllegalArgumentException("Too big position(",
+                position, ") or size(", size, ")");
+    }
+
+    int fd = ::open(path.c_str(), (mode == MapMode::READ_WRITE ?
+            O_RDWR : O_RDONLY) | O_CLOEXEC);
+    if (fd < 0) {
+        throw IOException("Unable to open file: ", std::strerror(errno));
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        int err = errno;
+        ::close(fd);
+        throw IOException("Unable to get file size: ", std::strerror(err));
+    }
+    if (position + size > u8(st.st_size)) {
+        if (mode != MapMode::READ_WRITE) {
+            ::close(fd);
+            throw IOException("Range [", position, ", ", position, " + ",
+                    size, ") out of bounds for file size ", st.st_size);
+        }
+        if (ftruncate(fd, position + size) != 0) {
+            int err = errno;
+            ::close(fd);
+            throw IOException("Unable to resize file: ", std::strerror(err));
+        }
+    }
+
+    if (size == 0) {
+        ::close(fd);
+        ByteBuffer<false> out(nullptr, 0, 0, false);
+        return mode == MapMode::READ_ONLY ? out.asReadOnly() : out;
+    }
+
+    //Смещение в mmap должно быть выровнено по размеру страницы
+    u8 delta = position % u8(sysconf(_SC_PAGESIZE));
+    size_t length = size + delta;
+    int prot = mode == MapMode::READ_ONLY ? PROT_READ : PROT_READ | PROT_WRITE;
+    int flags = mode == MapMode::PRIVATE ? MAP_PRIVATE : MAP_SHARED;
+    void *addr = mmap(nullptr, length, prot, flags, fd, position - delta);
+    int err = errno;
+    ::close(fd);
+    if (addr == MAP_FAILED) {
+        throw IOException("Unable to map file: ", std::strerror(err));
+    }
+
+    std::shared_ptr<char> ptr(reinterpret_cast<char*> (addr),
+            [length](char *p) {
+                munmap(p, length);
+            });
+    ByteBuffer<false> out(ptr, delta, size);
+    //Запись в память с PROT_READ привела бы к SIGSEGV
+    return mode == MapMode::READ_ONLY ? out.asReadOnly() : out;
+}
@@ -4,11 +4,16 @@
 #include <string>
 #include <experimental/filesystem>
 #include "jtypes.hpp"
+#include "ByteBuffer.hpp"
 
 namespace fs = std::experimental::filesystem::v1;
 
 namespace JIO {
 
+    enum class MapMode {
+        READ_ONLY, READ_WRITE, PRIVATE
+    };
+
     class File final {
     public:
 
@@ -34,6 +39,20 @@ namespace JIO {
         File getCanonicalFile() const;
         fs::path getCanonicalPath() const;
         std::vector<File> listFiles() const;
+
+        /**
+         * Отображает участок файла в память. Память освобождается вместе
+         * с последним буфером, ссылающимся на неё. В режиме READ_WRITE файл
+         * при необходимости расширяется, в режиме READ_ONLY возвращается
+         * буфер только для чтения (запись в него бросает
+         * ReadOnlyBufferException), в режиме PRIVATE изменения не попадают
+         * в файл.
+         */
+        ByteBuffer<false> map(MapMode mode, u8 position, u8 size) const;
+
+        inline ByteBuffer<false> map(MapMode mode) const {
+            return map(mode, 0, length());
+        }
     private:
         const fs::path path;
     };
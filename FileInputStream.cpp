@@ -1,58 +1,212 @@
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/ioctl.h>
+#include <sys/sendfile.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
 #include "FileStreams.hpp"
 
 using namespace JIO;
 
-FileInputStream::FileInputStream(const File f) :
-file(f),
-input() {
-    input.open(file.getPath(), std::ios::in | std::ios::binary);
+constexpr int IOV_BATCH = 64;
+
+static int openFile(const File &file) {
+    int fd;
+    do {
+        fd = ::open(file.getPath().c_str(), O_RDONLY | O_CLOEXEC);
+    } while (fd < 0 && errno == EINTR);
 
-    if (input.fail()) {
-        throw IOException("Unable to open file");
+    if (fd < 0) {
+        throw IOException("Unable to open file: ", std::strerror(errno));
     }
+    return fd;
 }
 
+FileInputStream::FileInputStream(const File f) :
+file(f),
+fd(openFile(f)) { }
+
 int FileInputStream::read() {
-    int out = input.get();
+    u1 out;
+    s8 n = read(&out, 0, 1);
+    return n <= 0 ? -1 : out;
+}
+
+s8 FileInputStream::read(void *buf, s8 offset, s8 length) {
+    if (length == 0) {
+        return 0;
+    }
+
+    char *data = checkSBounds<char*>(buf, offset, length);
+
+    ssize_t out;
+    do {
+        out = ::read(fd, data, length);
+    } while (out < 0 && errno == EINTR);
 
-    if (input.fail()) {
-        throw IOException("Read error");
+    if (out < 0) {
+        throw IOException("Read error: ", std::strerror(errno));
     }
+    return out == 0 ? -1 : out;
+}
 
-    return out;
+s8 FileInputStream::readv(const ReadSegment *segments, s8 count) {
+    checkSegments(segments, count);
+
+    struct iovec iov[IOV_BATCH];
+    s8 total = 0;
+    s8 i = 0;
+    while (i < count) {
+        int n = 0;
+        s8 expected = 0;
+        for (; i < count && n < IOV_BATCH; i++) {
+            const ReadSegment &seg = segments[i];
+            checkSBounds(seg.data, 0, seg.length);
+            if (seg.length == 0) {
+                continue;
+            }
+            iov[n].iov_base = seg.data;
+            iov[n].iov_len = seg.length;
+            expected += seg.length;
+            n++;
+        }
+        if (n == 0) {
+            break;
+        }
+
+        ssize_t out;
+        do {
+            out = ::readv(fd, iov, n);
+        } while (out < 0 && errno == EINTR);
+
+        if (out < 0) {
+            throw IOException("Read error: ", std::strerror(errno));
+        }
+        if (out == 0) {
+            return total == 0 ? -1 : total;
+        }
+        total += out;
+        if (out < expected) {
+            break;
+        }
+    }
+    return total;
 }
 
-s8 FileInputStream::read(void *buf, s8 offset, s8 length) {
+s8 FileInputStream::readAt(u8 position, void *buf, s8 offset, s8 length) {
     if (length == 0) {
         return 0;
     }
 
     char *data = checkSBounds<char*>(buf, offset, length);
 
-    if (input.peek() == -1) {
-        return -1;
+    ssize_t out;
+    do {
+        out = ::pread(fd, data, length, position);
+    } while (out < 0 && errno == EINTR);
+
+    if (out < 0) {
+        throw IOException("Read error: ", std::strerror(errno));
+    }
+    return out == 0 ? -1 : out;
+}
+
+s8 FileInputStream::skip(s8 count) {
+    if (count <= 0) {
+        return 0;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode)) {
+        //Не обычный файл, перемещение невозможно
+        return InputStream::skip(count);
     }
 
-    s8 out = input.readsome(data, length);
+    off_t pos = lseek(fd, 0, SEEK_CUR);
+    if (pos < 0) {
+        throw IOException("Seek error: ", std::strerror(errno));
+    }
 
-    if (input.fail()) {
-        throw IOException("Read error");
+    s8 avail = st.st_size > pos ? st.st_size - pos : 0;
+    s8 out = std::min(avail, count);
+    if (lseek(fd, out, SEEK_CUR) < 0) {
+        throw IOException("Seek error: ", std::strerror(errno));
     }
     return out;
 }
 
 s8 FileInputStream::available() {
-    std::streambuf *buf = input.rdbuf();
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        throw IOException("Unable to get available bytes: ",
+                std::strerror(errno));
+    }
 
-    if (input.fail() || buf == nullptr) {
-        throw IOException("Unable to get available bytes");
+    if (S_ISREG(st.st_mode)) {
+        off_t pos = lseek(fd, 0, SEEK_CUR);
+        if (pos < 0) {
+            throw IOException("Unable to get available bytes: ",
+                    std::strerror(errno));
+        }
+        return st.st_size > pos ? st.st_size - pos : 0;
     }
 
-    s8 out = buf->in_avail();
+    int out;
+    if (ioctl(fd, FIONREAD, &out) != 0) {
+        return 0;
+    }
     return out < 0 ? 0 : out;
 }
 
-FileInputStream::~FileInputStream() {
-    input.close();
+static bool isUnsupported(int err) {
+    return err == EXDEV || err == EINVAL || err == ENOSYS
+            || err == EBADF || err == EOPNOTSUPP || err == ETXTBSY;
+}
+
+s8 FileInputStream::transferTo(OutputStream &out, s8 max) {
+    constexpr s8 MAX_CHUNK = 1 << 30;
+    if (max < 0) {
+        throw IllegalArgumentException("max < 0");
+    }
+
+    FileOutputStream *fout = dynamic_cast<FileOutputStream*> (&out);
+    if (fout == nullptr) {
+        return InputStream::transferTo(out, max);
+    }
+
+    //Копирование внутри ядра: сначала copy_file_range, затем sendfile
+    int outfd = fout->getFD();
+    bool copy_range = true;
+    s8 total = 0;
+    while (total < max) {
+        size_t chunk = std::min(max - total, MAX_CHUNK);
+        ssize_t n = copy_range ?
+                copy_file_range(fd, nullptr, outfd, nullptr, chunk, 0) :
+                sendfile(outfd, fd, nullptr, chunk);
+        if (n < 0) {
+            int err = errno;
+            if (err == EINTR) {
+                continue;
+            }
+            if (total == 0 && isUnsupported(err)) {
+                if (copy_range) {
+                    copy_range = false;
+                    continue;
+                }
+                return InputStream::transferTo(out, max);
+            }
+            throw IOException("Transfer error: ", std::strerror(err));
+        }
+        if (n == 0) {
+            break;
+        }
+        total += n;
+    }
+    return total;
 }
 
+FileInputStream::~FileInputStream() {
+    ::close(fd);
+}
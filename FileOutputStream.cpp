@@ -1,48 +1,97 @@
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/uio.h>
+#include <unistd.h>
 #include "FileStreams.hpp"
 
 using namespace JIO;
 
-FileOutputStream::FileOutputStream(const File f, bool append) :
-file(f),
-output() {
-    std::ios::openmode mode = std::ios::out | std::ios::binary;
-    if (append) {
-        mode |= std::ios::in | std::ios::ate;
-    }
+constexpr int IOV_BATCH = 64;
+
+static int openFile(const File &file, bool append) {
+    int flags = O_WRONLY | O_CREAT | O_CLOEXEC | (append ? O_APPEND : O_TRUNC);
 
-    output.open(file.getPath(), mode);
+    int fd;
+    do {
+        fd = ::open(file.getPath().c_str(), flags, 0666);
+    } while (fd < 0 && errno == EINTR);
 
-    if (output.fail()) {
-        throw IOException("Unable to open file");
+    if (fd < 0) {
+        throw IOException("Unable to open file: ", std::strerror(errno));
     }
+    return fd;
 }
 
-void FileOutputStream::write(u1 byte) {
-    output.put(byte);
+FileOutputStream::FileOutputStream(const File f, bool append) :
+file(f),
+fd(openFile(f, append)) { }
 
-    if (output.fail()) {
-        throw IOException("Write error");
-    }
+void FileOutputStream::write(u1 byte) {
+    write(&byte, 0, 1);
 }
 
 void FileOutputStream::write(const void *buf, s8 offset, s8 length) {
     const char *data = checkSBounds<const char*>(buf, offset, length);
 
-    output.write(data, length);
-
-    if (output.fail()) {
-        throw IOException("Write error");
+    while (length > 0) {
+        ssize_t n = ::write(fd, data, length);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            throw IOException("Write error: ", std::strerror(errno));
+        }
+        data += n;
+        length -= n;
     }
 }
 
-void FileOutputStream::flush() {
-    output.flush();
+void FileOutputStream::writev(const WriteSegment *segments, s8 count) {
+    checkSegments(segments, count);
+
+    struct iovec iov[IOV_BATCH];
+    s8 i = 0;
+    while (i < count) {
+        int n = 0;
+        for (; i < count && n < IOV_BATCH; i++) {
+            const WriteSegment &seg = segments[i];
+            checkSBounds(seg.data, 0, seg.length);
+            if (seg.length == 0) {
+                continue;
+            }
+            iov[n].iov_base = const_cast<void*> (seg.data);
+            iov[n].iov_len = seg.length;
+            n++;
+        }
 
-    if (output.fail()) {
-        throw IOException("Flush error");
+        struct iovec *cur = iov;
+        while (n > 0) {
+            ssize_t out = ::writev(fd, cur, n);
+            if (out < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                throw IOException("Write error: ", std::strerror(errno));
+            }
+            //Пропуск полностью записанных участков
+            while (n > 0 && size_t(out) >= cur->iov_len) {
+                out -= cur->iov_len;
+                cur++;
+                n--;
+            }
+            if (n > 0) {
+                cur->iov_base = reinterpret_cast<char*> (cur->iov_base) + out;
+                cur->iov_len -= out;
+            }
+        }
     }
 }
 
+void FileOutputStream::flush() {
+    //Данные передаются системе сразу при записи
+}
+
 FileOutputStream::~FileOutputStream() {
-    output.close();
+    ::close(fd);
 }
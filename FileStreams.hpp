@@ -1,8 +1,9 @@
 #ifndef FILESTREAMS_HPP
 #define FILESTREAMS_HPP
 
-#include <fstream>
+#include <memory>
 #include "Streams.hpp"
+#include "ByteBufferStreams.hpp"
 #include "File.hpp"
 
 namespace JIO {
@@ -15,14 +16,30 @@ namespace JIO {
         FileInputStream(File(path)) { }
 
         using InputStream::read;
+        using InputStream::readv;
+        using InputStream::transferTo;
         virtual int read() override;
         virtual s8 read(void *buf, s8 offset, s8 length) override;
+        virtual s8 readv(const ReadSegment *segments, s8 count) override;
+        virtual s8 skip(s8 count) override;
         virtual s8 available() override;
+        virtual s8 transferTo(OutputStream &out, s8 max) override;
+
+        /**
+         * Читает данные начиная с позиции <code>position</code> в файле,
+         * не изменяя текущую позицию потока. Возвращаемое значение такое же,
+         * как у <code>read(void*, s8, s8)</code>.
+         */
+        s8 readAt(u8 position, void *buf, s8 offset, s8 length);
+
+        inline int getFD() const {
+            return fd;
+        }
 
         virtual ~FileInputStream() override;
     private:
         const File file;
-        std::ifstream input;
+        const int fd;
         FileInputStream(const FileInputStream&);
         FileInputStream& operator=(const FileInputStream&);
     };
@@ -35,18 +52,164 @@ namespace JIO {
         FileOutputStream(File(path), append) { }
 
         using OutputStream::write;
+        using OutputStream::writev;
         virtual void write(u1 byte) override;
         virtual void write(const void *buf, s8 offset, s8 length) override;
+        virtual void writev(const WriteSegment *segments, s8 count) override;
         virtual void flush() override;
 
+        inline int getFD() const {
+            return fd;
+        }
+
         virtual ~FileOutputStream() override;
     private:
         const File file;
-        std::ofstream output;
+        const int fd;
         FileOutputStream(const FileOutputStream&);
         FileOutputStream& operator=(const FileOutputStream&);
     };
+
+    /**
+     * Читает файл через его отображение в память, без промежуточного
+     * копирования в буферы потока.
+     */
+    class MappedFileInputStream : public ByteBufferInputStream {
+    public:
+        MappedFileInputStream(const File file);
+
+        inline MappedFileInputStream(std::string path) :
+        MappedFileInputStream(File(path)) { }
+
+        inline virtual ~MappedFileInputStream() override { }
+    private:
+        MappedFileInputStream(const MappedFileInputStream&);
+        MappedFileInputStream& operator=(const MappedFileInputStream&);
+    };
+
+    constexpr const s8 DEFAULT_DIRECT_BUFFER_SIZE = 1024 * 1024;
+
+    /**
+     * Последовательное чтение файла в обход кэша страниц (O_DIRECT).
+     * Данные читаются блоками размера буфера, выровненного по
+     * DIRECT_IO_ALIGNMENT, поэтому размер буфера должен быть ему кратен.
+     * Если файловая система не поддерживает O_DIRECT, конструктор бросает
+     * IOException.
+     */
+    class DirectFileInputStream final : public InputStream {
+    public:
+        DirectFileInputStream(const File file, s8 size);
+
+        inline DirectFileInputStream(const File file) :
+        DirectFileInputStream(file, DEFAULT_DIRECT_BUFFER_SIZE) { }
+
+        inline DirectFileInputStream(std::string path) :
+        DirectFileInputStream(File(path)) { }
+
+        using InputStream::read;
+        using InputStream::transferTo;
+        using InputStream::borrow;
+
+        inline virtual int read() override {
+            if (position < count) {
+                return buf[position++];
+            }
+            return readSlow();
+        }
+
+        virtual s8 read(void *buf, s8 offset, s8 length) override;
+        virtual s8 skip(s8 count) override;
+        virtual s8 available() override;
+        virtual s8 transferTo(OutputStream &out, s8 max) override;
+
+        /**
+         * Указатель возвращается, только если данные уже находятся
+         * в буфере: сдвиг данных нарушил бы выравнивание чтения.
+         */
+        virtual const u1* peek(s8 length) override;
+        virtual const u1* borrow(s8 length) override;
+
+        inline int getFD() const {
+            return fd;
+        }
+
+        inline s8 bufferSize() const {
+            return size;
+        }
+
+        virtual ~DirectFileInputStream() override;
+    private:
+        const File file;
+        //Буфер выделяется до открытия файла, чтобы ошибка выделения не
+        //оставляла открытый дескриптор
+        const s8 size;
+        std::unique_ptr<u1[], void(*)(void*)> buf;
+        const int fd;
+        s8 position;
+        s8 count;
+        bool eof;
+
+        s8 fill();
+        int readSlow();
+
+        DirectFileInputStream(const DirectFileInputStream&);
+        DirectFileInputStream& operator=(const DirectFileInputStream&);
+    };
+
+    /**
+     * Запись файла в обход кэша страниц (O_DIRECT). Данные записываются
+     * выровненными блоками, неполный последний блок при вызове
+     * <code>flush()</code> и в деструкторе записывается через кэш страниц
+     * со снятым на время флагом O_DIRECT и остаётся в буфере, чтобы
+     * следующая запись перезаписала его целиком.
+     */
+    class DirectFileOutputStream final : public OutputStream {
+    public:
+        DirectFileOutputStream(const File file, bool append, s8 size);
+
+        inline DirectFileOutputStream(const File file, bool append) :
+        DirectFileOutputStream(file, append, DEFAULT_DIRECT_BUFFER_SIZE) { }
+
+        inline DirectFileOutputStream(std::string path, bool append) :
+        DirectFileOutputStream(File(path), append) { }
+
+        using OutputStream::write;
+
+        inline virtual void write(u1 byte) override {
+            if (count >= size) {
+                writeBlocks();
+            }
+            buf[count++] = byte;
+        }
+
+        virtual void write(const void *buf, s8 offset, s8 length) override;
+        virtual void flush() override;
+
+        inline int getFD() const {
+            return fd;
+        }
+
+        inline s8 bufferSize() const {
+            return size;
+        }
+
+        virtual ~DirectFileOutputStream() override;
+    private:
+        const File file;
+        //Буфер выделяется до открытия файла, чтобы ошибка выделения не
+        //оставляла открытый дескриптор
+        const s8 size;
+        std::unique_ptr<u1[], void(*)(void*)> buf;
+        const int fd;
+        s8 count;
+        //Смещение в файле начала буфера, всегда выровнено
+        u8 filePosition;
+
+        void writeBlocks();
+
+        DirectFileOutputStream(const DirectFileOutputStream&);
+        DirectFileOutputStream& operator=(const DirectFileOutputStream&);
+    };
 }
 
 #endif /* FILESTREAMS_HPP */
-
@@ -10,9 +10,9 @@ count(length) { }
 
 int InMemoryInputStream::read() {
     u1 *tmp = reinterpret_cast<u1*> (data);
-    u8 tmp_pos = position + 1;
-    if (tmp_pos <= count) {
-        position = tmp_pos;
+    u8 tmp_pos = position;
+    if (tmp_pos < count) {
+        position = tmp_pos + 1;
         return tmp[tmp_pos];
     }
     return -1;
@@ -56,3 +56,36 @@ s8 InMemoryInputStream::skip(s8 n) {
 s8 InMemoryInputStream::available() {
     return count - position;
 }
+
+s8 InMemoryInputStream::transferTo(OutputStream &out, s8 max) {
+    if (max < 0) {
+        throw IllegalArgumentException("max < 0");
+    }
+
+    u8 tmp_pos = position;
+    u8 avail = count - tmp_pos;
+    if (avail > u8(max)) {
+        avail = max;
+    }
+
+    out.write(data, tmp_pos, avail);
+
+    position = tmp_pos + avail;
+    return avail;
+}
+
+const u1* InMemoryInputStream::peek(s8 length) {
+    checkLength(length);
+    if (u8(length) > count - position) {
+        return nullptr;
+    }
+    return reinterpret_cast<const u1*> (data) + position;
+}
+
+const u1* InMemoryInputStream::borrow(s8 length) {
+    const u1 *out = peek(length);
+    if (out != nullptr) {
+        position += length;
+    }
+    return out;
+}
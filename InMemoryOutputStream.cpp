@@ -0,0 +1,63 @@
+#include <cstdlib>
+#include <new>
+#include "InMemoryStreams.hpp"
+#include "mem_utils.hpp"
+
+using namespace JIO;
+
+InMemoryOutputStream::InMemoryOutputStream(size_t capacity) :
+data(nullptr),
+count(0),
+_capacity(0) {
+    reserve(capacity);
+}
+
+void InMemoryOutputStream::reserve(size_t capacity) {
+    if (capacity <= _capacity) {
+        return;
+    }
+    //Память выделяется через malloc, чтобы её мог освободить free_deleter
+    void *tmp = std::realloc(data, capacity);
+    if (tmp == nullptr) {
+        throw std::bad_alloc();
+    }
+    data = reinterpret_cast<u1*> (tmp);
+    _capacity = capacity;
+}
+
+void InMemoryOutputStream::grow(size_t min_capacity) {
+    if (min_capacity < count) {
+        throw IllegalArgumentException("Too big size: ", count, " + ",
+                min_capacity - count);
+    }
+    size_t capacity = _capacity < 16 ? 32 : _capacity * 2;
+    if (capacity < _capacity || capacity < min_capacity) {
+        capacity = min_capacity;
+    }
+    reserve(capacity);
+}
+
+void InMemoryOutputStream::write(const void *buf, s8 offset, s8 length) {
+    checkSBounds(buf, offset, length);
+
+    if (size_t(length) > _capacity - count) {
+        grow(count + length);
+    }
+
+    //Переполнение невозможно
+    copyBytes(data, count, buf, offset, length);
+    count += length;
+}
+
+ByteBuffer<true> InMemoryOutputStream::toByteBuffer() {
+    u1 *tmp = data;
+    size_t length = count;
+    data = nullptr;
+    count = 0;
+    _capacity = 0;
+    return ByteBuffer<true>(tmp, 0, length, true);
+}
+
+InMemoryOutputStream::~InMemoryOutputStream() {
+    std::free(data);
+}
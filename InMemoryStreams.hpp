@@ -10,10 +10,15 @@ namespace JIO {
         InMemoryInputStream(void *data, u8 offset, u8 length);
 
         using InputStream::read;
+        using InputStream::transferTo;
+        using InputStream::borrow;
         virtual int read() override;
         virtual s8 read(void *buf, s8 offset, s8 length) override;
         virtual s8 skip(s8 count) override;
         virtual s8 available() override;
+        virtual s8 transferTo(OutputStream &out, s8 max) override;
+        virtual const u1* peek(s8 length) override;
+        virtual const u1* borrow(s8 length) override;
 
         inline virtual ~InMemoryInputStream() override { }
     private:
@@ -24,22 +29,70 @@ namespace JIO {
         InMemoryInputStream& operator=(const InMemoryInputStream&);
     };
 
-    /*class InMemoryOutputStream : public OutputStream {
+    /**
+     * Поток записи в расширяемый буфер в памяти. Хранилище растёт
+     * геометрически и может быть передано в ByteBuffer без копирования.
+     */
+    class InMemoryOutputStream : public OutputStream {
     public:
+        InMemoryOutputStream(size_t capacity);
 
-        inline InMemoryOutputStream() {
-        }
+        inline InMemoryOutputStream() : InMemoryOutputStream(0) { }
 
         using OutputStream::write;
-        virtual void write(u1 byte) override;
+
+        inline virtual void write(u1 byte) override {
+            if (count == _capacity) {
+                grow(count + 1);
+            }
+            data[count++] = byte;
+        }
+
         virtual void write(const void *buf, s8 offset, s8 length) override;
-        virtual void flush() override;
+
+        /**
+         * Гарантирует, что в буфер можно записать не менее
+         * <code>capacity</code> байт без перераспределения памяти.
+         */
+        void reserve(size_t capacity);
+
+        inline void reset() {
+            count = 0;
+        }
+
+        inline size_t size() const {
+            return count;
+        }
+
+        inline size_t capacity() const {
+            return _capacity;
+        }
+
+        inline const u1* getData() const {
+            return data;
+        }
+
+        inline void writeTo(OutputStream &out) const {
+            out.write(data, 0, count);
+        }
+
+        /**
+         * Передаёт накопленные данные в ByteBuffer без копирования.
+         * После вызова поток пуст и не владеет памятью.
+         */
+        ByteBuffer<true> toByteBuffer();
 
         virtual ~InMemoryOutputStream() override;
     private:
+        u1 *data;
+        size_t count;
+        size_t _capacity;
+
+        void grow(size_t min_capacity);
+
         InMemoryOutputStream(const InMemoryOutputStream&);
         InMemoryOutputStream& operator=(const InMemoryOutputStream&);
-    };*/
+    };
 }
 
 #endif /* INMEMORYSTREAMS_HPP */
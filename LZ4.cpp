@@ -0,0 +1,254 @@
+#include <cstring>
+#include <memory>
+#include "LZ4.hpp"
+#include "exceptions.hpp"
+
+using namespace JIO;
+
+constexpr size_t MIN_MATCH = 4;
+constexpr size_t LAST_LITERALS = 5;
+constexpr size_t MF_LIMIT = 12;
+constexpr size_t MAX_DISTANCE = 65535;
+constexpr int HASH_LOG = 12;
+constexpr unsigned SKIP_TRIGGER = 6;
+
+static inline u4 read32(const u1 *p) {
+    u4 out;
+    std::memcpy(&out, p, 4);
+    return out;
+}
+
+static inline u4 hash(u4 sequence) {
+    return (sequence * 2654435761U) >> (32 - HASH_LOG);
+}
+
+static inline u1* writeLength(u1 *op, size_t length) {
+    while (length >= 255) {
+        *op++ = 255;
+        length -= 255;
+    }
+    *op++ = u1(length);
+    return op;
+}
+
+static inline u1* writeLiterals(u1 *op, const u1 *literals, size_t length) {
+    u1 *token = op++;
+    if (length >= 15) {
+        *token = 15 << 4;
+        op = writeLength(op, length - 15);
+    } else {
+        *token = u1(length << 4);
+    }
+    std::memcpy(op, literals, length);
+    return op + length;
+}
+
+size_t JIO::lz4Compress(const u1 *src, size_t length, u1 *dst, size_t capacity) {
+    if (capacity < lz4CompressBound(length)) {
+        throw IllegalArgumentException("Too small capacity: ", capacity);
+    }
+
+    u1 *op = dst;
+    size_t anchor = 0;
+    if (length > MF_LIMIT) {
+        u4 table[1 << HASH_LOG] = {};
+        const size_t mf_limit = length - MF_LIMIT;
+        const size_t match_limit = length - LAST_LITERALS;
+
+        size_t ip = 1;
+        while (ip < mf_limit) {
+            u4 sequence = read32(src + ip);
+            u4 h = hash(sequence);
+            size_t ref = table[h];
+            table[h] = u4(ip);
+
+            if (ref >= ip || ip - ref > MAX_DISTANCE
+                    || read32(src + ref) != sequence) {
+                //Ускорение на несжимаемых участках
+                ip += 1 + ((ip - anchor) >> SKIP_TRIGGER);
+                continue;
+            }
+
+            while (ip > anchor && ref > 0 && src[ip - 1] == src[ref - 1]) {
+                ip--;
+                ref--;
+            }
+
+            size_t match = MIN_MATCH;
+            while (ip + match < match_limit
+                    && src[ref + match] == src[ip + match]) {
+                match++;
+            }
+
+            u1 *token = op;
+            op = writeLiterals(op, src + anchor, ip - anchor);
+            size_t offset = ip - ref;
+            *op++ = u1(offset);
+            *op++ = u1(offset >> 8);
+            size_t extra = match - MIN_MATCH;
+            if (extra >= 15) {
+                *token |= 15;
+                op = writeLength(op, extra - 15);
+            } else {
+                *token |= u1(extra);
+            }
+
+            ip += match;
+            anchor = ip;
+            if (ip < mf_limit) {
+                table[hash(read32(src + ip - 2))] = u4(ip - 2);
+            }
+        }
+    }
+    op = writeLiterals(op, src + anchor, length - anchor);
+    return op - dst;
+}
+
+static inline void throwCorrupted(size_t position) {
+    throw IOException("Corrupted LZ4 block at ", position);
+}
+
+static inline size_t readLength(const u1 *src, size_t length, size_t &ip) {
+    size_t out = 0;
+    u1 b;
+    do {
+        if (ip >= length) {
+            throwCorrupted(ip);
+        }
+        b = src[ip++];
+        out += b;
+    } while (b == 255);
+    return out;
+}
+
+size_t JIO::lz4Decompress(const u1 *src, size_t length, u1 *dst, size_t capacity) {
+    size_t ip = 0;
+    size_t op = 0;
+    for (;;) {
+        if (ip >= length) {
+            throwCorrupted(ip);
+        }
+        u1 token = src[ip++];
+
+        size_t literals = token >> 4;
+        if (literals == 15) {
+            literals += readLength(src, length, ip);
+        }
+        if (literals > length - ip || literals > capacity - op) {
+            throwCorrupted(ip);
+        }
+        if (literals <= 16 && length - ip >= 16 && capacity - op >= 16) {
+            //Копия фиксированной длины, лишние байты будут перезаписаны
+            std::memcpy(dst + op, src + ip, 16);
+        } else {
+            std::memcpy(dst + op, src + ip, literals);
+        }
+        ip += literals;
+        op += literals;
+
+        if (ip == length) {
+            //Последовательность без совпадения завершает блок
+            return op;
+        }
+
+        if (length - ip < 2) {
+            throwCorrupted(ip);
+        }
+        size_t offset = src[ip] | (size_t(src[ip + 1]) << 8);
+        ip += 2;
+        if (offset == 0 || offset > op) {
+            throwCorrupted(ip);
+        }
+
+        size_t match = token & 15;
+        if (match == 15) {
+            match += readLength(src, length, ip);
+        }
+        match += MIN_MATCH;
+        if (match > capacity - op) {
+            throwCorrupted(ip);
+        }
+
+        u1 *out = dst + op;
+        const u1 *ref = out - offset;
+        if (offset >= 8 && capacity - op >= match + 8) {
+            //Копирование по 8 байт с выходом за конец совпадения
+            for (size_t k = 0; k < match; k += 8) {
+                std::memcpy(out + k, ref + k, 8);
+            }
+        } else if (offset >= match) {
+            std::memcpy(out, ref, match);
+        } else if (offset >= 8) {
+            //Перекрывающаяся копия: каждые 8 байт источника уже записаны
+            size_t k = 0;
+            for (; k + 8 <= match; k += 8) {
+                std::memcpy(out + k, ref + k, 8);
+            }
+            for (; k < match; k++) {
+                out[k] = ref[k];
+            }
+        } else {
+            for (size_t k = 0; k < match; k++) {
+                out[k] = ref[k];
+            }
+        }
+        op += match;
+    }
+}
+
+constexpr u4 PRIME32_1 = 2654435761U;
+constexpr u4 PRIME32_2 = 2246822519U;
+constexpr u4 PRIME32_3 = 3266489917U;
+constexpr u4 PRIME32_4 = 668265263U;
+constexpr u4 PRIME32_5 = 374761393U;
+
+static inline u4 rotl32(u4 x, int r) {
+    return (x << r) | (x >> (32 - r));
+}
+
+static inline u4 round32(u4 acc, u4 input) {
+    acc += input * PRIME32_2;
+    acc = rotl32(acc, 13);
+    return acc * PRIME32_1;
+}
+
+u4 JIO::xxHash32(const void *data, size_t length, u4 seed) {
+    const u1 *p = reinterpret_cast<const u1*> (data);
+    const u1 *end = p + length;
+    u4 h;
+
+    if (length >= 16) {
+        u4 v1 = seed + PRIME32_1 + PRIME32_2;
+        u4 v2 = seed + PRIME32_2;
+        u4 v3 = seed;
+        u4 v4 = seed - PRIME32_1;
+        const u1 *limit = end - 16;
+        do {
+            v1 = round32(v1, read32(p));
+            v2 = round32(v2, read32(p + 4));
+            v3 = round32(v3, read32(p + 8));
+            v4 = round32(v4, read32(p + 12));
+            p += 16;
+        } while (p <= limit);
+        h = rotl32(v1, 1) + rotl32(v2, 7) + rotl32(v3, 12) + rotl32(v4, 18);
+    } else {
+        h = seed + PRIME32_5;
+    }
+
+    h += u4(length);
+    for (; p + 4 <= end; p += 4) {
+        h += read32(p) * PRIME32_3;
+        h = rotl32(h, 17) * PRIME32_4;
+    }
+    for (; p < end; p++) {
+        h += (*p) * PRIME32_5;
+        h = rotl32(h, 11) * PRIME32_1;
+    }
+
+    h ^= h >> 15;
+    h *= PRIME32_2;
+    h ^= h >> 13;
+    h *= PRIME32_3;
+    h ^= h >> 16;
+    return h;
+}
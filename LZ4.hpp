@@ -0,0 +1,35 @@
+#ifndef LZ4_HPP
+#define LZ4_HPP
+
+#include <cstddef>
+#include "jtypes.hpp"
+
+namespace JIO {
+
+    /**
+     * Максимальный размер сжатого представления блока длины
+     * <code>length</code>.
+     */
+    inline size_t lz4CompressBound(size_t length) {
+        return length + length / 255 + 16;
+    }
+
+    /**
+     * Сжимает блок в формате LZ4 block. <code>capacity</code> должна быть
+     * не меньше <code>lz4CompressBound(length)</code>. Возвращается размер
+     * сжатых данных.
+     */
+    size_t lz4Compress(const u1 *src, size_t length, u1 *dst, size_t capacity);
+
+    /**
+     * Распаковывает блок в формате LZ4 block. Возвращается размер
+     * распакованных данных. При повреждённых данных или нехватке места
+     * бросается IOException.
+     */
+    size_t lz4Decompress(const u1 *src, size_t length, u1 *dst, size_t capacity);
+
+    u4 xxHash32(const void *data, size_t length, u4 seed);
+}
+
+#endif /* LZ4_HPP */
+
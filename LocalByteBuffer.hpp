@@ -0,0 +1,164 @@
+#ifndef LOCALBYTEBUFFER_HPP
+#define LOCALBYTEBUFFER_HPP
+
+#include <utility>
+#include "ByteBufferView.hpp"
+
+namespace JIO {
+
+    template<bool>
+    class LocalByteBuffer;
+
+    /**
+     * Владение памятью ByteBuffer с неатомарным счётчиком ссылок.
+     * Исходный буфер захватывается один раз, дальнейшие копии меняют
+     * только обычный счётчик в общем блоке. Перемещение копирует, чтобы
+     * объект никогда не оставался без блока.
+     */
+    class LocalOwner {
+    private:
+
+        struct Block {
+            size_t refs;
+            const ByteBuffer<false> memory;
+        };
+
+        Block *block;
+    public:
+
+        inline explicit LocalOwner(const ByteBuffer<false> &memory) :
+        block(new Block{1, memory}) { }
+
+        inline LocalOwner(const LocalOwner &other) noexcept :
+        block(other.block) {
+            block->refs++;
+        }
+
+        inline LocalOwner& operator=(const LocalOwner &other) noexcept {
+            LocalOwner tmp(other);
+            std::swap(block, tmp.block);
+            return *this;
+        }
+
+        inline size_t useCount() const {
+            return block->refs;
+        }
+
+        inline const ByteBuffer<false>& getMemory() const {
+            return block->memory;
+        }
+
+        inline ~LocalOwner() {
+            if (--block->refs == 0) {
+                delete block;
+            }
+        }
+    };
+
+    /**
+     * Владеющий буфер с интерфейсом ByteBufferView для однопоточного
+     * использования. Копирование, срезы и operator[] не используют
+     * атомарных операций, поэтому разбор данных может свободно делить
+     * буфер на части. Копии одного буфера нельзя создавать и уничтожать
+     * из разных потоков одновременно; для передачи в другой поток
+     * служит <code>share()</code>.
+     */
+    template<>
+    class LocalByteBuffer<false> : public ByteBufferView<false> {
+    protected:
+        LocalOwner owner;
+
+        inline LocalByteBuffer(const ByteBufferView<false> &view,
+                const LocalOwner &owner) :
+        ByteBufferView<false>(view), owner(owner) { }
+    public:
+
+        inline explicit LocalByteBuffer(const ByteBuffer<false> &buf) :
+        ByteBufferView<false>(buf), owner(buf) { }
+
+        inline explicit LocalByteBuffer(size_t capacity) :
+        LocalByteBuffer(ByteBuffer<false>(capacity)) { }
+
+        inline LocalByteBuffer(const LocalByteBuffer<true> &buf);
+
+        /**
+         * Буфер с атомарным счётчиком ссылок над той же памятью.
+         */
+        inline ByteBuffer<false> share() const {
+            const ByteBuffer<false> &memory = owner.getMemory();
+            return memory.slice(data - memory.getData(), _capacity);
+        }
+
+        inline size_t useCount() const {
+            return owner.useCount();
+        }
+
+        inline LocalByteBuffer slice(size_t index, size_t length) const {
+            return LocalByteBuffer(ByteBufferView<false>::slice(index, length), owner);
+        }
+
+        inline LocalByteBuffer clone(size_t index, size_t length) const {
+            return LocalByteBuffer(ByteBufferView<false>::clone(index, length));
+        }
+
+        inline LocalByteBuffer clone() const {
+            return clone(0, _capacity);
+        }
+
+        inline LocalByteBuffer<true> operator[](size_t) const;
+    };
+
+    template<>
+    class LocalByteBuffer<true> : public ByteBufferView<true> {
+    protected:
+        LocalOwner owner;
+
+        inline LocalByteBuffer(const ByteBufferView<true> &view,
+                const LocalOwner &owner) :
+        ByteBufferView<true>(view), owner(owner) { }
+    public:
+
+        inline explicit LocalByteBuffer(const ByteBuffer<false> &buf) :
+        ByteBufferView<true>(buf), owner(buf) { }
+
+        inline explicit LocalByteBuffer(const ByteBuffer<true> &buf) :
+        ByteBufferView<true>(buf), owner(buf) { }
+
+        inline explicit LocalByteBuffer(size_t capacity) :
+        LocalByteBuffer(ByteBuffer<false>(capacity)) { }
+
+        inline ByteBuffer<true> share() const {
+            const ByteBuffer<false> &memory = owner.getMemory();
+            ByteBuffer<true> out = memory[0].slice(data - memory.getData(), _capacity);
+            out.position(position());
+            return out;
+        }
+
+        inline size_t useCount() const {
+            return owner.useCount();
+        }
+
+        inline LocalByteBuffer slice(size_t index, size_t length) const {
+            return LocalByteBuffer(ByteBufferView<true>::slice(index, length), owner);
+        }
+
+        inline LocalByteBuffer clone(size_t index, size_t length) const {
+            return LocalByteBuffer(ByteBufferView<true>::clone(index, length));
+        }
+
+        inline LocalByteBuffer clone() const {
+            return clone(0, _capacity);
+        }
+
+        friend LocalByteBuffer<false>;
+    };
+
+    inline LocalByteBuffer<false>::LocalByteBuffer(const LocalByteBuffer<true> &buf) :
+    ByteBufferView<false>(buf), owner(buf.owner) { }
+
+    inline LocalByteBuffer<true> LocalByteBuffer<false>::operator[](size_t pos) const {
+        return LocalByteBuffer<true>(ByteBufferView<false>::operator[](pos), owner);
+    }
+}
+
+#endif /* LOCALBYTEBUFFER_HPP */
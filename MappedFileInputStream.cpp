@@ -0,0 +1,6 @@
+#include "FileStreams.hpp"
+
+using namespace JIO;
+
+MappedFileInputStream::MappedFileInputStream(const File file) :
+ByteBufferInputStream(file.map(MapMode::READ_ONLY)) { }
@@ -2,13 +2,68 @@
 #define INPUTSTREAM_HPP
 
 #include <algorithm>
+#include <initializer_list>
+#include <type_traits>
 #include "exceptions.hpp"
 #include "jtypes.hpp"
 #include "checks.hpp"
+#include "ByteBuffer.hpp"
 
 namespace JIO {
 
+    class OutputStream;
+
+    /**
+     * Участок памяти для векторного чтения.
+     */
+    struct ReadSegment {
+        void *data;
+        s8 length;
+
+        inline ReadSegment(void *data, s8 length) :
+        data(data), length(length) { }
+
+        inline ReadSegment(const ByteBuffer<false> &buf) :
+        data(buf.getData()), length(buf.capacity()) {
+            if (buf.isReadOnly()) {
+                throw ReadOnlyBufferException();
+            }
+        }
+    };
+
+    /**
+     * Участок памяти для векторной записи.
+     */
+    struct WriteSegment {
+        const void *data;
+        s8 length;
+
+        inline WriteSegment(const void *data, s8 length) :
+        data(data), length(length) { }
+
+        inline WriteSegment(const ByteBuffer<false> &buf) :
+        data(buf.getData()), length(buf.capacity()) { }
+    };
+
+    inline void checkSegments(const void *segments, s8 count) {
+        if (count < 0) {
+            throw JIO::IndexOutOfBoundsException(
+                    "Negative segments count(", count, ")");
+        }
+        if (count != 0 && segments == nullptr) {
+            throw IllegalArgumentException("segments == nullptr");
+        }
+    }
+
     class InputStream {
+    protected:
+
+        static inline void checkLength(s8 length) {
+            if (length < 0) {
+                throw JIO::IndexOutOfBoundsException(
+                        "Negative length(", length, ")");
+            }
+        }
     public:
         /**
          * Читает байт и возвращает значение в промежутке от 0 до 255.
@@ -58,6 +113,38 @@ namespace JIO {
             return i;
         }
 
+        /**
+         * Последовательно заполняет <code>count</code> участков памяти из
+         * <code>segments</code>. Возвращается общее количество прочитанных
+         * байт. Чтение прекращается, если очередной участок заполнен
+         * не полностью. При достижении конца данных до начала чтения,
+         * будет возвращено специальное знаение -1
+         */
+        inline virtual s8 readv(const ReadSegment *segments, s8 count) {
+            checkSegments(segments, count);
+
+            s8 total = 0;
+            for (s8 i = 0; i < count; i++) {
+                const ReadSegment &seg = segments[i];
+                if (seg.length == 0) {
+                    continue;
+                }
+                s8 n = read(seg.data, 0, seg.length);
+                if (n < 0) {
+                    return total == 0 ? -1 : total;
+                }
+                total += n;
+                if (n < seg.length) {
+                    break;
+                }
+            }
+            return total;
+        }
+
+        inline s8 readv(std::initializer_list<ReadSegment> segments) {
+            return readv(segments.begin(), segments.size());
+        }
+
         inline virtual void readFully(void *buf, s8 length) {
             readFully(buf, 0, length);
         }
@@ -72,6 +159,24 @@ namespace JIO {
             } while (n < length);
         }
 
+        /**
+         * Читает <code>count</code> тривиально копируемых объектов одним
+         * вызовом <code>readFully</code>. Версия с порядком байт допускает
+         * только числа и перечисления.
+         */
+        template<typename T>
+        inline void readObjects(T *data, size_t count) {
+            static_assert(std::is_trivially_copyable<T>::value,
+                    "T must be trivially copyable");
+            readFully(data, checkArrayLength(count, sizeof (T)));
+        }
+
+        template<ByteOrder order, typename T>
+        inline void readObjects(T *data, size_t count) {
+            readObjects(data, count);
+            convertOrder<order>(data, data, count);
+        }
+
         inline virtual s8 skip(s8 count) {
             constexpr s8 SKIP_BUFFER_SIZE = 2048;
             static u1 SKIP_BUFFER[SKIP_BUFFER_SIZE];
@@ -97,6 +202,52 @@ namespace JIO {
             return 0;
         }
 
+        /**
+         * Возвращает указатель на следующие <code>length</code> байт потока,
+         * не считая их прочитанными, или nullptr, если поток не может
+         * предоставить их непрерывным участком своей памяти. Указатель
+         * действителен до следующего вызова любого метода потока.
+         */
+        inline virtual const u1* peek(s8 length) {
+            checkLength(length);
+            return nullptr;
+        }
+
+        /**
+         * То же, что <code>peek(s8)</code>, но при успехе байты считаются
+         * прочитанными.
+         */
+        inline virtual const u1* borrow(s8 length) {
+            checkLength(length);
+            return nullptr;
+        }
+
+        /**
+         * Возвращает указатель на следующие <code>length</code> байт потока
+         * без копирования, если это возможно, иначе читает их
+         * в <code>scratch</code> и возвращает его. Если данных не хватает,
+         * бросается EOFException.
+         */
+        inline const u1* borrow(s8 length, void *scratch) {
+            const u1 *out = borrow(length);
+            if (out == nullptr) {
+                readFully(scratch, length);
+                out = reinterpret_cast<const u1*> (scratch);
+            }
+            return out;
+        }
+
+        /**
+         * Передаёт в <code>out</code> не более <code>max</code> байт из
+         * потока, пока не будет достигнут конец данных. Возвращается
+         * количество переданных байт.
+         */
+        virtual s8 transferTo(OutputStream &out, s8 max);
+
+        inline s8 transferTo(OutputStream &out) {
+            return transferTo(out, INT64_MAX);
+        }
+
         inline virtual ~InputStream() { };
     };
 
@@ -116,10 +267,78 @@ namespace JIO {
             }
         }
 
+        /**
+         * Записывает <code>count</code> тривиально копируемых объектов
+         * одним вызовом <code>write</code>. При несовпадении порядка байт
+         * с порядком платформы массив преобразуется блоками через
+         * промежуточный буфер.
+         */
+        template<typename T>
+        inline void writeObjects(const T *data, size_t count) {
+            static_assert(std::is_trivially_copyable<T>::value,
+                    "T must be trivially copyable");
+            write(data, 0, checkArrayLength(count, sizeof (T)));
+        }
+
+        template<ByteOrder order, typename T>
+        inline void writeObjects(const T *data, size_t count) {
+            static_assert(std::is_arithmetic<T>::value || std::is_enum<T>::value,
+                    "T must be arithmetic or enum type");
+            constexpr size_t CHUNK_SIZE = 4096 / sizeof (T);
+            if (order == NATIVE_ORDER || sizeof (T) == 1) {
+                writeObjects(data, count);
+                return;
+            }
+            checkArrayLength(count, sizeof (T));
+            T tmp[CHUNK_SIZE];
+            while (count > 0) {
+                size_t n = std::min(count, CHUNK_SIZE);
+                convertOrder<order>(tmp, data, n);
+                write(tmp, 0, n * sizeof (T));
+                data += n;
+                count -= n;
+            }
+        }
+
+        /**
+         * Последовательно записывает <code>count</code> участков памяти из
+         * <code>segments</code>.
+         */
+        inline virtual void writev(const WriteSegment *segments, s8 count) {
+            checkSegments(segments, count);
+
+            for (s8 i = 0; i < count; i++) {
+                write(segments[i].data, 0, segments[i].length);
+            }
+        }
+
+        inline void writev(std::initializer_list<WriteSegment> segments) {
+            writev(segments.begin(), segments.size());
+        }
+
         inline virtual void flush() { }
 
         inline virtual ~OutputStream() { };
     };
+
+    inline s8 InputStream::transferTo(OutputStream &out, s8 max) {
+        constexpr s8 TRANSFER_BUFFER_SIZE = 8192;
+        if (max < 0) {
+            throw IllegalArgumentException("max < 0");
+        }
+
+        u1 buf[TRANSFER_BUFFER_SIZE];
+        s8 total = 0;
+        while (total < max) {
+            s8 n = read(buf, 0, std::min(TRANSFER_BUFFER_SIZE, max - total));
+            if (n < 0) {
+                break;
+            }
+            out.write(buf, 0, n);
+            total += n;
+        }
+        return total;
+    }
 }
 
 #endif /* INPUTSTREAM_HPP */
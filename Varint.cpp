@@ -0,0 +1,236 @@
+#include "Varint.hpp"
+
+#ifdef __SSE2__
+#include <immintrin.h>
+#endif
+
+using namespace JIO;
+
+static inline void checkValue(u8 value, u4*) {
+    if (value > UINT32_MAX) {
+        throw IOException("Varint value ", value,
+                " does not fit in u4");
+    }
+}
+
+static inline void checkValue(u8, u8*) { }
+
+#ifdef __SSE2__
+
+static inline void widen(__m128i v, u4 *dst) {
+    const __m128i zero = _mm_setzero_si128();
+    __m128i lo = _mm_unpacklo_epi8(v, zero);
+    __m128i hi = _mm_unpackhi_epi8(v, zero);
+    __m128i *out = reinterpret_cast<__m128i*> (dst);
+    _mm_storeu_si128(out + 0, _mm_unpacklo_epi16(lo, zero));
+    _mm_storeu_si128(out + 1, _mm_unpackhi_epi16(lo, zero));
+    _mm_storeu_si128(out + 2, _mm_unpacklo_epi16(hi, zero));
+    _mm_storeu_si128(out + 3, _mm_unpackhi_epi16(hi, zero));
+}
+
+static inline void widen(__m128i v, u8 *dst) {
+    alignas(16) u4 tmp[16];
+    widen(v, tmp);
+    const __m128i zero = _mm_setzero_si128();
+    __m128i *out = reinterpret_cast<__m128i*> (dst);
+    for (int i = 0; i < 4; i++) {
+        __m128i w = _mm_load_si128(reinterpret_cast<const __m128i*> (tmp) + i);
+        _mm_storeu_si128(out + 2 * i, _mm_unpacklo_epi32(w, zero));
+        _mm_storeu_si128(out + 2 * i + 1, _mm_unpackhi_epi32(w, zero));
+    }
+}
+
+//Записывают 4 числа из 32-битных ячеек
+static inline void store4(__m128i v, u4 *dst) {
+    _mm_storeu_si128(reinterpret_cast<__m128i*> (dst), v);
+}
+
+static inline void store4(__m128i v, u8 *dst) {
+    const __m128i zero = _mm_setzero_si128();
+    __m128i *out = reinterpret_cast<__m128i*> (dst);
+    _mm_storeu_si128(out + 0, _mm_unpacklo_epi32(v, zero));
+    _mm_storeu_si128(out + 1, _mm_unpackhi_epi32(v, zero));
+}
+
+/*
+ * Разбор 8 байт по маске битов продолжения: перестановка собирает байты
+ * первых чисел в 16-битные (числа до 2 байт, не более 8 штук) или
+ * 32-битные (числа до 3 байт, не более 4 штук) ячейки, лишние байты
+ * ячеек обнуляются (индекс 0x80). width == 0, если первое число длиннее
+ * 3 байт или не заканчивается в этих 8 байтах.
+ */
+struct ShuffleEntry {
+    u1 shuffle[16];
+    u1 width;
+    u1 count;
+    u1 bytes;
+};
+
+struct ShuffleTable {
+    ShuffleEntry entries[256];
+};
+
+static constexpr ShuffleEntry makeEntry(unsigned mask) {
+    ShuffleEntry out{};
+    unsigned offsets[8] = {};
+    unsigned lengths[8] = {};
+    unsigned total = 0;
+    for (unsigned p = 0; p < 8; total++) {
+        unsigned end = p;
+        while (end < 8 && ((mask >> end) & 1) != 0) {
+            end++;
+        }
+        if (end == 8) {
+            break;
+        }
+        offsets[total] = p;
+        lengths[total] = end - p + 1;
+        p = end + 1;
+    }
+    unsigned n2 = 0;
+    while (n2 < total && lengths[n2] <= 2) {
+        n2++;
+    }
+    unsigned n3 = 0;
+    while (n3 < total && n3 < 4 && lengths[n3] <= 3) {
+        n3++;
+    }
+    for (unsigned k = 0; k < 16; k++) {
+        out.shuffle[k] = 0x80;
+    }
+    unsigned width = 0, count = 0;
+    if (n2 > 0 && n2 >= n3) {
+        width = 2;
+        count = n2;
+    } else if (n3 > 0) {
+        width = 4;
+        count = n3;
+    }
+    unsigned bytes = 0;
+    for (unsigned j = 0; j < count; j++) {
+        for (unsigned k = 0; k < lengths[j]; k++) {
+            out.shuffle[j * width + k] = u1(offsets[j] + k);
+        }
+        bytes += lengths[j];
+    }
+    out.width = u1(width);
+    out.count = u1(count);
+    out.bytes = u1(bytes);
+    return out;
+}
+
+static constexpr ShuffleTable makeTable() {
+    ShuffleTable out{};
+    for (unsigned mask = 0; mask < 256; mask++) {
+        out.entries[mask] = makeEntry(mask);
+    }
+    return out;
+}
+
+static constexpr ShuffleTable SHUFFLE_TABLE = makeTable();
+
+/*
+ * Обрабатывает числа, пока остаётся не меньше 16 байт и 16 чисел:
+ * записи по таблице всегда пишут 8 ячеек dst. Числа длиннее 3 байт и
+ * неканонические записи передаются decodeVarint.
+ */
+template<typename T>
+__attribute__((target("ssse3")))
+static void decodeSSSE3(const u1 *src, size_t length, T *dst, size_t count,
+        size_t &pos, size_t &i) {
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i low7 = _mm_set1_epi16(0x007f);
+    const __m128i high7 = _mm_set1_epi16(0x7f00);
+    const __m128i byte0 = _mm_set1_epi32(0x0000007f);
+    const __m128i byte1 = _mm_set1_epi32(0x00007f00);
+    const __m128i byte2 = _mm_set1_epi32(0x007f0000);
+    while (count - i >= 16 && length - pos >= 16) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*> (src + pos));
+        unsigned mask = _mm_movemask_epi8(v);
+        if (mask == 0) {
+            //16 однобайтовых чисел подряд
+            widen(v, dst + i);
+            pos += 16;
+            i += 16;
+            continue;
+        }
+        const ShuffleEntry &e = SHUFFLE_TABLE.entries[mask & 0xff];
+        //Нулевой последний байт многобайтового числа
+        unsigned zeros = _mm_movemask_epi8(_mm_cmpeq_epi8(v, zero));
+        if (e.width == 0 || (zeros & (mask << 1) & ((1u << e.bytes) - 1)) != 0) {
+            u8 value = decodeVarint(src, length, pos);
+            checkValue(value, dst);
+            dst[i++] = value;
+            continue;
+        }
+        __m128i s = _mm_shuffle_epi8(v, _mm_loadu_si128(
+                reinterpret_cast<const __m128i*> (e.shuffle)));
+        if (e.width == 2) {
+            s = _mm_or_si128(_mm_and_si128(s, low7),
+                    _mm_srli_epi16(_mm_and_si128(s, high7), 1));
+            store4(_mm_unpacklo_epi16(s, zero), dst + i);
+            store4(_mm_unpackhi_epi16(s, zero), dst + i + 4);
+        } else {
+            s = _mm_or_si128(_mm_or_si128(_mm_and_si128(s, byte0),
+                    _mm_srli_epi32(_mm_and_si128(s, byte1), 1)),
+                    _mm_srli_epi32(_mm_and_si128(s, byte2), 2));
+            store4(s, dst + i);
+        }
+        pos += e.bytes;
+        i += e.count;
+    }
+}
+
+static bool detectSSSE3() {
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("ssse3");
+}
+
+static const bool HAS_SSSE3 = detectSSSE3();
+
+#endif
+
+template<typename T>
+static size_t decode(const u1 *src, size_t length, T *dst, size_t count) {
+    size_t pos = 0;
+    size_t i = 0;
+#ifdef __SSE2__
+    if (HAS_SSSE3) {
+        decodeSSSE3(src, length, dst, count, pos, i);
+    }
+    while (count - i >= 16 && length - pos >= 16) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*> (src + pos));
+        unsigned mask = _mm_movemask_epi8(v);
+        if (mask == 0) {
+            //16 однобайтовых чисел подряд
+            widen(v, dst + i);
+            pos += 16;
+            i += 16;
+            continue;
+        }
+        unsigned run = __builtin_ctz(mask);
+        for (unsigned k = 0; k < run; k++) {
+            dst[i + k] = src[pos + k];
+        }
+        pos += run;
+        i += run;
+        u8 value = decodeVarint(src, length, pos);
+        checkValue(value, dst);
+        dst[i++] = value;
+    }
+#endif
+    for (; i < count; i++) {
+        u8 value = decodeVarint(src, length, pos);
+        checkValue(value, dst);
+        dst[i] = value;
+    }
+    return pos;
+}
+
+size_t JIO::decodeVarints(const u1 *src, size_t length, u4 *dst, size_t count) {
+    return decode(src, length, dst, count);
+}
+
+size_t JIO::decodeVarints(const u1 *src, size_t length, u8 *dst, size_t count) {
+    return decode(src, length, dst, count);
+}
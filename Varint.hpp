@@ -0,0 +1,82 @@
+#ifndef VARINT_HPP
+#define VARINT_HPP
+
+#include <cstddef>
+#include "jtypes.hpp"
+#include "exceptions.hpp"
+
+namespace JIO {
+
+    constexpr const size_t MAX_VARINT_LENGTH = 10;
+
+    inline u8 zigZagEncode(s8 value) {
+        return (u8(value) << 1) ^ u8(value >> 63);
+    }
+
+    inline s8 zigZagDecode(u8 value) {
+        return s8(value >> 1) ^ -s8(value & 1);
+    }
+
+    /**
+     * Записывает <code>value</code> в формате LEB128 и возвращает количество
+     * записанных байт (не более MAX_VARINT_LENGTH).
+     */
+    inline size_t encodeVarint(u8 value, u1 *out) {
+        size_t n = 0;
+        while (value >= 0x80) {
+            out[n++] = u1(value) | 0x80;
+            value >>= 7;
+        }
+        out[n++] = u1(value);
+        return n;
+    }
+
+    /**
+     * Проверяет последний байт числа, начатого со сдвигом <code>shift</code>:
+     * многобайтовое число не может заканчиваться нулевым байтом, а десятый
+     * байт может содержать только старший бит u8.
+     */
+    inline bool isVarintEnd(u1 b, unsigned shift) {
+        return (b != 0 || shift == 0) && (shift < 63 || b <= 1);
+    }
+
+    /**
+     * Читает число в формате LEB128 из <code>data</code> начиная с
+     * <code>pos</code> и сдвигает <code>pos</code> за его конец.
+     * Для неканонической записи или числа больше u8 бросает IOException.
+     */
+    inline u8 decodeVarint(const u1 *data, size_t length, size_t &pos) {
+        size_t tmp_pos = pos;
+        u8 out = 0;
+        for (unsigned shift = 0; shift < 64; shift += 7) {
+            if (tmp_pos >= length) {
+                throw IndexOutOfBoundsException("Truncated varint at ", pos);
+            }
+            u1 b = data[tmp_pos++];
+            out |= u8(b & 0x7f) << shift;
+            if ((b & 0x80) == 0) {
+                if (!isVarintEnd(b, shift)) {
+                    break;
+                }
+                pos = tmp_pos;
+                return out;
+            }
+        }
+        throw IOException("Malformed varint at ", pos);
+    }
+
+    /**
+     * Читает <code>count</code> чисел в формате LEB128 из <code>src</code>
+     * и возвращает количество прочитанных байт. Ошибки те же, что у
+     * decodeVarint; число, не помещающееся в u4, также даёт IOException.
+     * При поддержке SSSE3 числа длиной до 3 байт раскладываются по
+     * таблице перестановок, индексируемой битами продолжения 8 байт
+     * (до 8 чисел за шаг); 16 однобайтовых чисел подряд расширяются
+     * без таблицы.
+     */
+    size_t decodeVarints(const u1 *src, size_t length, u4 *dst, size_t count);
+    size_t decodeVarints(const u1 *src, size_t length, u8 *dst, size_t count);
+}
+
+#endif /* VARINT_HPP */
+
@@ -37,6 +37,18 @@ namespace JIO {
         return offdata;
     }
 
+    /**
+     * Проверяет, что массив из <code>count</code> элементов размера
+     * <code>size</code> занимает не больше INT64_MAX байт, и возвращает
+     * его длину в байтах.
+     */
+    inline s8 checkArrayLength(u8 count, u8 size) {
+        if (count > u8(INT64_MAX) / size) {
+            throw IllegalArgumentException("Too big array length: ", count);
+        }
+        return count * size;
+    }
+
     template<typename T = void*>
     inline T checkUBounds(const void *data, u8 offset, u8 length) {
         u8 intdata = reinterpret_cast<u8> (data);
@@ -78,6 +78,22 @@ namespace JIO {
         JException(formatMsg("IndexOutOfBoundsException", why...)) { }
     };
 
+    /**
+     * Попытка записи в буфер, доступный только для чтения.
+     */
+    class ReadOnlyBufferException : public JException {
+    protected:
+
+        inline ReadOnlyBufferException(std::string msg) :
+        JException(msg) { }
+
+    public:
+
+        template<typename... T>
+        inline ReadOnlyBufferException(T... why) :
+        JException(formatMsg("ReadOnlyBufferException", why...)) { }
+    };
+
     class IOException : public JException {
     protected:
 
@@ -0,0 +1,259 @@
+/*
+ * Copyright (c) 2023 Vladimir Kozelkov
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef FAST_MATH_HPP
+#define FAST_MATH_HPP
+
+#include <cmath>
+#include "Vector.hpp"
+
+// -std=c++17
+namespace JIO {
+
+    inline namespace detail {
+
+        namespace simd {
+
+            /*
+             * Скалярный f4 с интерфейсом traits: через него приближённые
+             * функции считаются для f4 и для векторов без SIMD-представления.
+             * min и max, как и minps/maxps, возвращают второй аргумент,
+             * если первый - NaN.
+             */
+            struct scalar_f4 {
+                using value_type = f4;
+                using reg = f4;
+
+                static reg set1(f4 v) {
+                    return v;
+                }
+
+                static reg add(reg a, reg b) {
+                    return a + b;
+                }
+
+                static reg sub(reg a, reg b) {
+                    return a - b;
+                }
+
+                static reg mul(reg a, reg b) {
+                    return a * b;
+                }
+
+                static reg div(reg a, reg b) {
+                    return a / b;
+                }
+
+                static reg min(reg a, reg b) {
+                    return a < b ? a : b;
+                }
+
+                static reg max(reg a, reg b) {
+                    return a > b ? a : b;
+                }
+
+                static reg abs(reg a) {
+                    return std::fabs(a);
+                }
+
+                static reg round(reg a) {
+                    return std::nearbyint(a);
+                }
+
+                static bool greater(reg a, reg b) {
+                    return a > b;
+                }
+
+                static reg select(bool m, reg a, reg b) {
+                    return m ? a : b;
+                }
+
+                static reg copysign(reg magnitude, reg sign) {
+                    return std::copysign(magnitude, sign);
+                }
+
+                static reg rsqrt(reg a) {
+#if defined(__SSE2__)
+                    return _mm_cvtss_f32(_mm_rsqrt_ss(_mm_set_ss(a)));
+#else
+                    return 1.0f / std::sqrt(a);
+#endif
+                }
+            };
+
+        } // namespace simd
+
+        namespace fast_math {
+
+            // pi = PI_A + PI_B + PI_C, q * PI_A и q * PI_B точны при |q| < 2^13
+            constexpr f4 PI_A = 3.140625f;
+            constexpr f4 PI_B = 9.675025939941406e-4f;
+            constexpr f4 PI_C = 1.5099580252808664e-7f;
+            constexpr f4 INV_PI = 0.318309886183790671538f;
+            constexpr f4 HALF_PI = 1.57079632679489661923f;
+
+            // x - q * pi / scale
+            template<typename S>
+            inline typename S::reg reducePi(typename S::reg x, typename S::reg q, f4 scale) {
+                x = S::sub(x, S::mul(q, S::set1(PI_A * scale)));
+                x = S::sub(x, S::mul(q, S::set1(PI_B * scale)));
+                return S::sub(x, S::mul(q, S::set1(PI_C * scale)));
+            }
+
+            // (-1)^q для целого q
+            template<typename S>
+            inline typename S::reg signOf(typename S::reg q) {
+                auto half = S::round(S::sub(S::mul(q, S::set1(0.5f)), S::set1(0.25f)));
+                auto parity = S::sub(q, S::add(half, half));
+                return S::sub(S::set1(1.0f), S::add(parity, parity));
+            }
+
+            // sin(d) при |d| <= pi / 2
+            template<typename S>
+            inline typename S::reg sinPoly(typename S::reg d) {
+                auto s = S::mul(d, d);
+                auto u = S::set1(2.6083159809786593541503e-06f);
+                u = S::add(S::mul(u, s), S::set1(-0.0001981069071916863322258f));
+                u = S::add(S::mul(u, s), S::set1(0.00833307858556509017944336f));
+                u = S::add(S::mul(u, s), S::set1(-0.166666597127914428710938f));
+                return S::add(S::mul(s, S::mul(u, d)), d);
+            }
+
+            template<typename S>
+            inline typename S::reg sin(typename S::reg x) {
+                auto q = S::round(S::mul(x, S::set1(INV_PI)));
+                auto d = reducePi<S>(x, q, 1.0f);
+                return sinPoly<S>(S::mul(d, signOf<S>(q)));
+            }
+
+            // cos(x) = -(-1)^j * sin(x - (j + 1/2) * pi)
+            template<typename S>
+            inline typename S::reg cos(typename S::reg x) {
+                auto j = S::round(S::sub(S::mul(x, S::set1(INV_PI)), S::set1(0.5f)));
+                auto q = S::add(S::add(j, j), S::set1(1.0f));
+                auto d = reducePi<S>(x, q, 0.5f);
+                return sinPoly<S>(S::mul(d, S::sub(S::set1(0.0f), signOf<S>(j))));
+            }
+
+            template<typename S>
+            inline typename S::reg atan(typename S::reg x) {
+                auto a = S::abs(x);
+                auto one = S::set1(1.0f);
+                auto t = S::div(S::min(one, a), S::max(one, a));
+                auto s = S::mul(t, t);
+                auto u = S::set1(0.00282363896258175373077393f);
+                u = S::add(S::mul(u, s), S::set1(-0.0159569028764963150024414f));
+                u = S::add(S::mul(u, s), S::set1(0.0425049886107444763183594f));
+                u = S::add(S::mul(u, s), S::set1(-0.0748900920152664184570312f));
+                u = S::add(S::mul(u, s), S::set1(0.106347933411598205566406f));
+                u = S::add(S::mul(u, s), S::set1(-0.142027363181114196777344f));
+                u = S::add(S::mul(u, s), S::set1(0.199926957488059997558594f));
+                u = S::add(S::mul(u, s), S::set1(-0.333331018686294555664062f));
+                t = S::add(t, S::mul(t, S::mul(s, u)));
+                t = S::select(S::greater(a, one), S::sub(S::set1(HALF_PI), t), t);
+                return S::copysign(t, x);
+            }
+
+            // Один шаг Ньютона: y * (1.5 - 0.5 * x * y * y)
+            template<typename S>
+            inline typename S::reg rsqrt(typename S::reg x) {
+                auto y = S::rsqrt(x);
+                auto hx = S::mul(x, S::set1(0.5f));
+                return S::mul(y, S::sub(S::set1(1.5f), S::mul(hx, S::mul(y, y))));
+            }
+
+            template<size_t size, typename F>
+            inline Vector<f4, size> map(const Vector<f4, size> &v, F &&f) {
+                using S = simd::traits<f4, size>;
+                Vector<f4, size> out;
+                if constexpr (simd::enabled<simd::has_round, f4, size>
+                              && simd::enabled<simd::has_greater, f4, size>
+                              && simd::enabled<simd::has_copysign, f4, size>
+                              && simd::enabled<simd::has_rsqrt, f4, size>) {
+                    S::store(&out[0], f(S{}, S::load(&v[0])));
+                    // дополнительные элементы остаются нулевыми
+                    for (size_t i = size; i < S::storage_size; i++) {
+                        (&out[0])[i] = 0.0f;
+                    }
+                } else {
+                    for (size_t i = 0; i < size; i++) {
+                        out[i] = f(simd::scalar_f4{}, v[i]);
+                    }
+                }
+                return out;
+            }
+
+        } // namespace fast_math
+
+    } // namespace detail
+
+    /*
+     * Приближённые функции для f4 и Vector<f4, size>: полиномы и
+     * приближение 1/sqrt на SIMD-регистрах вместо вызова libm для каждого
+     * элемента. Функции не constexpr. Ошибка относительно точного
+     * значения, измеренная на SSE2, SSE4.1 и AVX2:
+     *  - sin, cos: не более 2 ULP при |x| <= pi; при |x| <= 8192 абсолютная
+     *    ошибка не больше 1.5e-7 (вне этого промежутка результат не
+     *    определён);
+     *  - atan: не более 3 ULP для всех конечных x, atan(+-inf) = +-pi/2;
+     *  - rsqrt, inverseLength: не более 5 ULP (относительная ошибка 3e-7)
+     *    для нормализованных x;
+     *  - normalize: длина результата отличается от 1 не более чем на 3e-7.
+     */
+    namespace fast {
+
+#define FAST_UNARY_F(name)                                                            \
+        inline f4 name(f4 x) {                                                        \
+            return detail::fast_math::name<detail::simd::scalar_f4>(x);               \
+        }                                                                             \
+        template<size_t size>                                                         \
+        inline Vector<f4, size> name(const Vector<f4, size> &v) {                     \
+            return detail::fast_math::map(v, [](auto s, auto x) {                     \
+                return detail::fast_math::name<decltype(s)>(x);                       \
+            });                                                                       \
+        }
+
+        FAST_UNARY_F(sin)
+
+        FAST_UNARY_F(cos)
+
+        FAST_UNARY_F(atan)
+
+        FAST_UNARY_F(rsqrt)
+
+#undef FAST_UNARY_F
+
+        template<size_t size>
+        inline f4 inverseLength(const Vector<f4, size> &v) {
+            return rsqrt(dot(v, v));
+        }
+
+        template<size_t size>
+        inline Vector<f4, size> normalize(const Vector<f4, size> &v) {
+            return v * inverseLength(v);
+        }
+
+    } // namespace fast
+
+} // namespace JIO
+
+#endif /* FAST_MATH_HPP */
@@ -0,0 +1,481 @@
+/*
+ * Copyright (c) 2023 Vladimir Kozelkov
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef MATRIX_HPP
+#define MATRIX_HPP
+
+#include "Vector.hpp"
+#include "VectorArray.hpp"
+
+// -std=c++17
+namespace JIO {
+
+    template<typename T, size_t rows, size_t columns>
+    class Matrix;
+
+    inline namespace detail {
+
+        namespace simd {
+
+#if defined(__SSE2__)
+
+            /*
+             * Обращение 4x4 блочным методом через присоединённые матрицы
+             * 2x2. Вход и выход - четыре столбца по 16 байт.
+             */
+            struct inverse4 {
+                template<int x, int y, int z, int w>
+                static __m128 swizzle(__m128 v) {
+                    return _mm_shuffle_ps(v, v, _MM_SHUFFLE(w, z, y, x));
+                }
+
+                template<int x, int y, int z, int w>
+                static __m128 shuffle(__m128 a, __m128 b) {
+                    return _mm_shuffle_ps(a, b, _MM_SHUFFLE(w, z, y, x));
+                }
+
+                // A * B
+                static __m128 mul2(__m128 a, __m128 b) {
+                    return _mm_add_ps(_mm_mul_ps(a, swizzle<0, 3, 0, 3>(b)),
+                                      _mm_mul_ps(swizzle<1, 0, 3, 2>(a), swizzle<2, 1, 2, 1>(b)));
+                }
+
+                // adj(A) * B
+                static __m128 adjMul2(__m128 a, __m128 b) {
+                    return _mm_sub_ps(_mm_mul_ps(swizzle<3, 3, 0, 0>(a), b),
+                                      _mm_mul_ps(swizzle<1, 1, 2, 2>(a), swizzle<2, 3, 0, 1>(b)));
+                }
+
+                // A * adj(B)
+                static __m128 mulAdj2(__m128 a, __m128 b) {
+                    return _mm_sub_ps(_mm_mul_ps(a, swizzle<3, 0, 3, 0>(b)),
+                                      _mm_mul_ps(swizzle<1, 0, 3, 2>(a), swizzle<2, 1, 2, 1>(b)));
+                }
+
+                static void apply(const f4 *in, f4 *out) {
+                    __m128 c0 = _mm_load_ps(in), c1 = _mm_load_ps(in + 4);
+                    __m128 c2 = _mm_load_ps(in + 8), c3 = _mm_load_ps(in + 12);
+
+                    __m128 a = _mm_movelh_ps(c0, c1);
+                    __m128 b = _mm_movehl_ps(c1, c0);
+                    __m128 c = _mm_movelh_ps(c2, c3);
+                    __m128 d = _mm_movehl_ps(c3, c2);
+
+                    __m128 det_sub = _mm_sub_ps(
+                            _mm_mul_ps(shuffle<0, 2, 0, 2>(c0, c2), shuffle<1, 3, 1, 3>(c1, c3)),
+                            _mm_mul_ps(shuffle<1, 3, 1, 3>(c0, c2), shuffle<0, 2, 0, 2>(c1, c3)));
+                    __m128 det_a = swizzle<0, 0, 0, 0>(det_sub);
+                    __m128 det_b = swizzle<1, 1, 1, 1>(det_sub);
+                    __m128 det_c = swizzle<2, 2, 2, 2>(det_sub);
+                    __m128 det_d = swizzle<3, 3, 3, 3>(det_sub);
+
+                    __m128 d_c = adjMul2(d, c);
+                    __m128 a_b = adjMul2(a, b);
+                    __m128 x = _mm_sub_ps(_mm_mul_ps(det_d, a), mul2(b, d_c));
+                    __m128 w = _mm_sub_ps(_mm_mul_ps(det_a, d), mul2(c, a_b));
+                    __m128 y = _mm_sub_ps(_mm_mul_ps(det_b, c), mulAdj2(d, a_b));
+                    __m128 z = _mm_sub_ps(_mm_mul_ps(det_c, b), mulAdj2(a, d_c));
+
+                    __m128 det = _mm_add_ps(_mm_mul_ps(det_a, det_d), _mm_mul_ps(det_b, det_c));
+                    __m128 tr = _mm_mul_ps(a_b, swizzle<0, 2, 1, 3>(d_c));
+                    tr = _mm_add_ps(tr, swizzle<2, 3, 0, 1>(tr));
+                    tr = _mm_add_ps(tr, swizzle<1, 0, 3, 2>(tr));
+                    det = _mm_sub_ps(det, tr);
+
+                    __m128 rdet = _mm_div_ps(_mm_setr_ps(1.0f, -1.0f, -1.0f, 1.0f), det);
+                    x = _mm_mul_ps(x, rdet);
+                    y = _mm_mul_ps(y, rdet);
+                    z = _mm_mul_ps(z, rdet);
+                    w = _mm_mul_ps(w, rdet);
+
+                    _mm_store_ps(out, shuffle<3, 1, 3, 1>(x, y));
+                    _mm_store_ps(out + 4, shuffle<2, 0, 2, 0>(x, y));
+                    _mm_store_ps(out + 8, shuffle<3, 1, 3, 1>(z, w));
+                    _mm_store_ps(out + 12, shuffle<2, 0, 2, 0>(z, w));
+                }
+            };
+
+            constexpr bool has_inverse4 = true;
+#else
+            struct inverse4 {
+                static void apply(const f4 *, f4 *) {}
+            };
+
+            constexpr bool has_inverse4 = false;
+#endif
+
+        } // namespace simd
+
+        template<typename T>
+        constexpr T abs_value(T v) {
+            return v < T{} ? -v : v;
+        }
+
+    } // namespace detail
+
+    /*
+     * Матрица rows x columns, хранящаяся по столбцам: m[j] - j-й столбец,
+     * m(i, j) - элемент i-й строки j-го столбца.
+     */
+    template<typename T, size_t rows, size_t columns>
+    class Matrix {
+        static_assert(rows > 0 && columns > 0, "matrix size must be greater than 0");
+
+    private:
+        Vector<T, rows> data[columns]{};
+
+    public:
+        constexpr Matrix() = default;
+
+        template<typename... Tp,
+                std::enable_if_t<sizeof...(Tp) == columns && columns != 1, bool> = true>
+        constexpr explicit Matrix(const Vector<Tp, rows> &... cols) : data{Vector<T, rows>(cols)...} {}
+
+        constexpr explicit Matrix(const Vector<T, rows> &col) : data{col} {
+            static_assert(columns == 1, "Wrong arguments length");
+        }
+
+        /*
+         * Матрица с value на главной диагонали.
+         */
+        static constexpr Matrix diagonal(const T &value) {
+            Matrix out;
+            for (size_t i = 0; i < rows && i < columns; i++) {
+                out.data[i][i] = value;
+            }
+            return out;
+        }
+
+        static constexpr Matrix identity() {
+            return diagonal(T{1});
+        }
+
+        constexpr const Vector<T, rows> &operator[](size_t column) const {
+            return data[column];
+        }
+
+        constexpr Vector<T, rows> &operator[](size_t column) {
+            return data[column];
+        }
+
+        constexpr const T &operator()(size_t row, size_t column) const {
+            return data[column][row];
+        }
+
+        constexpr T &operator()(size_t row, size_t column) {
+            return data[column][row];
+        }
+
+        constexpr Vector<T, columns> row(size_t index) const {
+            Vector<T, columns> out;
+            for (size_t j = 0; j < columns; j++) {
+                out[j] = data[j][index];
+            }
+            return out;
+        }
+    };
+
+    template<typename T, size_t rows, size_t columns, typename CharT, typename Traits>
+    inline std::basic_ostream<CharT, Traits> &operator<<(
+            std::basic_ostream<CharT, Traits> &out, const Matrix<T, rows, columns> &m) {
+        out << '{';
+        for (size_t i = 0; i < rows; i++) {
+            if (i) {
+                out << ',' << ' ';
+            }
+            out << m.row(i);
+        }
+        out << '}';
+        return out;
+    }
+
+    template<typename T, size_t rows, size_t columns>
+    constexpr Matrix<T, columns, rows> transpose(const Matrix<T, rows, columns> &m) {
+        Matrix<T, columns, rows> out;
+        for (size_t i = 0; i < rows; i++) {
+            out[i] = m.row(i);
+        }
+        return out;
+    }
+
+    template<typename T, size_t rows, size_t columns>
+    constexpr Vector<T, rows> operator*(const Matrix<T, rows, columns> &m, const Vector<T, columns> &v) {
+        if constexpr (detail::simd::enabled<detail::simd::has_mul, T, rows>
+                      && detail::simd::enabled<detail::simd::has_add, T, rows>) {
+            if (!detail::is_constant_evaluated()) {
+                using S = detail::simd::traits<T, rows>;
+                Vector<T, rows> out;
+                auto acc = S::mul(S::load(&m[0][0]), S::set1(v[0]));
+                for (size_t j = 1; j < columns; j++) {
+                    acc = S::add(acc, S::mul(S::load(&m[j][0]), S::set1(v[j])));
+                }
+                S::store(&out[0], acc);
+                return out;
+            }
+        }
+        Vector<T, rows> out = m[0] * v[0];
+        for (size_t j = 1; j < columns; j++) {
+            out += m[j] * v[j];
+        }
+        return out;
+    }
+
+    template<typename T, size_t rows, size_t inner, size_t columns>
+    constexpr Matrix<T, rows, columns> operator*(const Matrix<T, rows, inner> &m1,
+                                                 const Matrix<T, inner, columns> &m2) {
+        Matrix<T, rows, columns> out;
+        for (size_t j = 0; j < columns; j++) {
+            out[j] = m1 * m2[j];
+        }
+        return out;
+    }
+
+#define MATRIX_MM_OPERATOR(op)                                                             \
+    template<typename T, size_t rows, size_t columns>                                      \
+    constexpr Matrix<T, rows, columns> operator op(const Matrix<T, rows, columns> &m1,     \
+                                                   const Matrix<T, rows, columns> &m2) {   \
+        Matrix<T, rows, columns> out;                                                      \
+        for (size_t j = 0; j < columns; j++) {                                             \
+            out[j] = m1[j] op m2[j];                                                       \
+        }                                                                                  \
+        return out;                                                                        \
+    }
+
+    MATRIX_MM_OPERATOR(+)
+
+    MATRIX_MM_OPERATOR(-)
+
+#undef MATRIX_MM_OPERATOR
+
+    template<typename T, size_t rows, size_t columns>
+    constexpr Matrix<T, rows, columns> operator*(const Matrix<T, rows, columns> &m, const T &value) {
+        Matrix<T, rows, columns> out;
+        for (size_t j = 0; j < columns; j++) {
+            out[j] = m[j] * value;
+        }
+        return out;
+    }
+
+    template<typename T, size_t rows, size_t columns>
+    constexpr Matrix<T, rows, columns> operator-(const Matrix<T, rows, columns> &m) {
+        Matrix<T, rows, columns> out;
+        for (size_t j = 0; j < columns; j++) {
+            out[j] = -m[j];
+        }
+        return out;
+    }
+
+    /*
+     * Матрица без строки row и столбца column.
+     */
+    template<typename T, size_t size>
+    constexpr Matrix<T, size - 1, size - 1> submatrix(const Matrix<T, size, size> &m,
+                                                  size_t row, size_t column) {
+        Matrix<T, size - 1, size - 1> out;
+        for (size_t j = 0, oj = 0; j < size; j++) {
+            if (j == column) {
+                continue;
+            }
+            for (size_t i = 0, oi = 0; i < size; i++) {
+                if (i != row) {
+                    out(oi++, oj) = m(i, j);
+                }
+            }
+            oj++;
+        }
+        return out;
+    }
+
+    /*
+     * Определитель разложением по первому столбцу, поэтому точен для
+     * целых T. Рассчитан на небольшие матрицы.
+     */
+    template<typename T, size_t size>
+    constexpr T determinant(const Matrix<T, size, size> &m) {
+        if constexpr (size == 1) {
+            return m(0, 0);
+        } else if constexpr (size == 2) {
+            return m(0, 0) * m(1, 1) - m(0, 1) * m(1, 0);
+        } else {
+            T out{};
+            for (size_t i = 0; i < size; i++) {
+                T term = m(i, 0) * determinant(submatrix(m, i, 0));
+                out = (i & 1) ? out - term : out + term;
+            }
+            return out;
+        }
+    }
+
+    /*
+     * Обратная матрица методом Гаусса-Жордана с выбором главного
+     * элемента. Для вырожденной матрицы результат содержит бесконечности
+     * или NaN. Для Matrix<f4, 4, 4> используется блочный метод на SSE.
+     */
+    template<typename T, size_t size>
+    constexpr Matrix<T, size, size> inverse(const Matrix<T, size, size> &m) {
+        static_assert(std::is_floating_point_v<T>, "T must be floating point type");
+        if constexpr (std::is_same_v<T, f4> && size == 4 && detail::simd::has_inverse4) {
+            if (!detail::is_constant_evaluated()) {
+                Matrix<T, size, size> out;
+                detail::simd::inverse4::apply(&m[0][0], &out[0][0]);
+                return out;
+            }
+        }
+        Matrix<T, size, size> a = m;
+        Matrix<T, size, size> out = Matrix<T, size, size>::identity();
+        for (size_t k = 0; k < size; k++) {
+            size_t pivot = k;
+            for (size_t i = k + 1; i < size; i++) {
+                if (detail::abs_value(a(i, k)) > detail::abs_value(a(pivot, k))) {
+                    pivot = i;
+                }
+            }
+            if (pivot != k) {
+                for (size_t j = 0; j < size; j++) {
+                    T tmp = a(k, j);
+                    a(k, j) = a(pivot, j);
+                    a(pivot, j) = tmp;
+                    tmp = out(k, j);
+                    out(k, j) = out(pivot, j);
+                    out(pivot, j) = tmp;
+                }
+            }
+            T scale = T{1} / a(k, k);
+            for (size_t j = 0; j < size; j++) {
+                a(k, j) *= scale;
+                out(k, j) *= scale;
+            }
+            for (size_t i = 0; i < size; i++) {
+                T factor = a(i, k);
+                if (i == k || factor == T{}) {
+                    continue;
+                }
+                for (size_t j = 0; j < size; j++) {
+                    a(i, j) -= factor * a(k, j);
+                    out(i, j) -= factor * out(k, j);
+                }
+            }
+        }
+        return out;
+    }
+
+    /*
+     * out[i] = m * in[i] для всех векторов массива. in и out должны
+     * иметь одинаковый размер; out может совпадать с in.
+     */
+    template<typename T, size_t rows, size_t columns>
+    void transform(const Matrix<T, rows, columns> &m, const VectorArray<T, columns> &in,
+                   VectorArray<T, rows> &out) {
+        size_t i = 0, length = out.size();
+        detail::checkBatchSize(in.size(), length);
+        if constexpr (detail::simd::batch_enabled<T, detail::simd::has_add, detail::simd::has_mul>) {
+            using S = detail::simd::batch_traits<T>;
+            constexpr size_t lanes = detail::simd::batch_lanes<T>;
+            for (; i + lanes <= length; i += lanes) {
+                // весь блок читается до первой записи
+                typename S::reg acc[rows];
+                for (size_t r = 0; r < rows; r++) {
+                    acc[r] = S::mul(S::load(in.column(0) + i), S::set1(m(r, 0)));
+                    for (size_t c = 1; c < columns; c++) {
+                        acc[r] = S::add(acc[r], S::mul(S::load(in.column(c) + i), S::set1(m(r, c))));
+                    }
+                }
+                for (size_t r = 0; r < rows; r++) {
+                    S::store(out.column(r) + i, acc[r]);
+                }
+            }
+        }
+        for (; i < length; i++) {
+            out.set(i, m * in.get(i));
+        }
+    }
+
+    template<typename T, size_t rows, size_t columns>
+    VectorArray<T, rows> transform(const Matrix<T, rows, columns> &m,
+                                   const VectorArray<T, columns> &in) {
+        VectorArray<T, rows> out(in.size());
+        transform(m, in, out);
+        return out;
+    }
+
+    /*
+     * Аффинное преобразование точек: out[i] = (m * (in[i], 1)) без
+     * последней координаты. Деление на w не выполняется. in и out
+     * должны иметь одинаковый размер; out может совпадать с in.
+     */
+    template<typename T, size_t size>
+    void transformPoints(const Matrix<T, size + 1, size + 1> &m, const VectorArray<T, size> &in,
+                         VectorArray<T, size> &out) {
+        size_t i = 0, length = out.size();
+        detail::checkBatchSize(in.size(), length);
+        if constexpr (detail::simd::batch_enabled<T, detail::simd::has_add, detail::simd::has_mul>) {
+            using S = detail::simd::batch_traits<T>;
+            constexpr size_t lanes = detail::simd::batch_lanes<T>;
+            for (; i + lanes <= length; i += lanes) {
+                typename S::reg acc[size];
+                for (size_t r = 0; r < size; r++) {
+                    acc[r] = S::set1(m(r, size));
+                    for (size_t c = 0; c < size; c++) {
+                        acc[r] = S::add(acc[r], S::mul(S::load(in.column(c) + i), S::set1(m(r, c))));
+                    }
+                }
+                for (size_t r = 0; r < size; r++) {
+                    S::store(out.column(r) + i, acc[r]);
+                }
+            }
+        }
+        for (; i < length; i++) {
+            T acc[size];
+            for (size_t r = 0; r < size; r++) {
+                acc[r] = m(r, size);
+                for (size_t c = 0; c < size; c++) {
+                    acc[r] += in.column(c)[i] * m(r, c);
+                }
+            }
+            for (size_t r = 0; r < size; r++) {
+                out.column(r)[i] = acc[r];
+            }
+        }
+    }
+
+    template<typename T, size_t size>
+    VectorArray<T, size> transformPoints(const Matrix<T, size + 1, size + 1> &m,
+                                         const VectorArray<T, size> &in) {
+        VectorArray<T, size> out(in.size());
+        transformPoints(m, in, out);
+        return out;
+    }
+
+    /*
+     * То же для count векторов, лежащих подряд.
+     */
+    template<typename T, size_t rows, size_t columns>
+    void transform(const Matrix<T, rows, columns> &m, const Vector<T, columns> *in,
+                   Vector<T, rows> *out, size_t count) {
+        for (size_t i = 0; i < count; i++) {
+            out[i] = m * in[i];
+        }
+    }
+
+} // namespace JIO
+
+#endif /* MATRIX_HPP */
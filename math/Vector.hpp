@@ -26,6 +26,7 @@
 #include <cmath>
 #include <type_traits>
 #include <ostream>
+#include "VectorSimd.hpp"
 
 // -std=c++17
 namespace JIO {
@@ -41,7 +42,7 @@ namespace JIO {
                     std::conditional_t<std::is_lvalue_reference_v<T>, TT &, TT &&>;
 
             template<typename T, typename TT>
-            inline forward_ret_t<T> forward(TT &&v) noexcept {
+            constexpr forward_ret_t<T> forward(TT &&v) noexcept {
                 return static_cast<T &&> (v);
             }
         }
@@ -89,6 +90,38 @@ namespace JIO {
         }, src, dst);
     }
 
+    template<size_t... index, typename T, size_t size>
+    constexpr Vector<T, sizeof...(index)> shuffle(const Vector<T, size> &v);
+
+#define SWIZZLE2(a, ia, b, ib)                                                      \
+        constexpr auto a##b() const {                                               \
+            return shuffle<ia, ib>(*this);                                          \
+        }
+#define SWIZZLE3(a, ia, b, ib, c, ic)                                               \
+        constexpr auto a##b##c() const {                                            \
+            return shuffle<ia, ib, ic>(*this);                                      \
+        }
+#define SWIZZLE4(a, ia, b, ib, c, ic, d, id)                                        \
+        constexpr auto a##b##c##d() const {                                         \
+            return shuffle<ia, ib, ic, id>(*this);                                  \
+        }
+#define SWIZZLE_XYZW_1(m, ...) m(__VA_ARGS__, x, 0) m(__VA_ARGS__, y, 1)            \
+                               m(__VA_ARGS__, z, 2) m(__VA_ARGS__, w, 3)
+#define SWIZZLE_XYZW_2(m, ...) SWIZZLE_XYZW_1(m, __VA_ARGS__, x, 0)                 \
+                               SWIZZLE_XYZW_1(m, __VA_ARGS__, y, 1)                 \
+                               SWIZZLE_XYZW_1(m, __VA_ARGS__, z, 2)                 \
+                               SWIZZLE_XYZW_1(m, __VA_ARGS__, w, 3)
+#define SWIZZLE_XYZW_3(m, ...) SWIZZLE_XYZW_2(m, __VA_ARGS__, x, 0)                 \
+                               SWIZZLE_XYZW_2(m, __VA_ARGS__, y, 1)                 \
+                               SWIZZLE_XYZW_2(m, __VA_ARGS__, z, 2)                 \
+                               SWIZZLE_XYZW_2(m, __VA_ARGS__, w, 3)
+#define SWIZZLE_2(m) SWIZZLE_XYZW_1(m, x, 0) SWIZZLE_XYZW_1(m, y, 1)                \
+                     SWIZZLE_XYZW_1(m, z, 2) SWIZZLE_XYZW_1(m, w, 3)
+#define SWIZZLE_3(m) SWIZZLE_XYZW_2(m, x, 0) SWIZZLE_XYZW_2(m, y, 1)                \
+                     SWIZZLE_XYZW_2(m, z, 2) SWIZZLE_XYZW_2(m, w, 3)
+#define SWIZZLE_4(m) SWIZZLE_XYZW_3(m, x, 0) SWIZZLE_XYZW_3(m, y, 1)                \
+                     SWIZZLE_XYZW_3(m, z, 2) SWIZZLE_XYZW_3(m, w, 3)
+
     template<typename T, size_t size>
     class Vector {
         static_assert(size > 0, "vector size must be greater than 0");
@@ -96,7 +129,9 @@ namespace JIO {
         static_assert(!is_vector<T>::value, "vector can`t contain another vector");
 
     private:
-        T data[size];
+        using simd_layout = detail::simd::layout<T, size>;
+
+        alignas(simd_layout::alignment) T data[simd_layout::storage_size]{};
 
         template<size_t index>
         constexpr void assign() {
@@ -142,11 +177,81 @@ namespace JIO {
             return data[index];
         }
 
+        /*
+         * Перестановки элементов в стиле GLSL: v.zyx(), v.xxyy() и т.д.
+         * x, y, z, w - элементы с индексами 0, 1, 2, 3.
+         */
+        SWIZZLE_2(SWIZZLE2)
+
+        SWIZZLE_3(SWIZZLE3)
+
+        SWIZZLE_4(SWIZZLE4)
+
         template<typename, size_t>
         friend
         class Vector;
     };
 
+#undef SWIZZLE2
+#undef SWIZZLE3
+#undef SWIZZLE4
+#undef SWIZZLE_XYZW_1
+#undef SWIZZLE_XYZW_2
+#undef SWIZZLE_XYZW_3
+#undef SWIZZLE_2
+#undef SWIZZLE_3
+#undef SWIZZLE_4
+
+    inline namespace detail {
+
+        template<size_t... index>
+        struct index_list {
+            static constexpr size_t value[] = {index...};
+        };
+
+        /*
+         * Индексы для всего регистра: дополнительные элементы результата
+         * берутся из нулевого дополнения источника, если оно есть.
+         */
+        template<typename S, size_t size, size_t... index, size_t... lane>
+        inline typename S::reg shuffle_register(typename S::reg a, std::index_sequence<lane...>) {
+            constexpr size_t pad = size < S::storage_size ? size : 0;
+            return S::template shuffle<(lane < sizeof...(index)
+                                        ? index_list<index...>::value[lane] : pad)...>(a);
+        }
+
+    } // namespace detail
+
+    /*
+     * Вектор из элементов v с индексами index...; для SIMD-векторов
+     * с общим регистром - одна инструкция shufps/pshufd/vpermps.
+     */
+    template<size_t... index, typename T, size_t size>
+    constexpr Vector<T, sizeof...(index)> shuffle(const Vector<T, size> &v) {
+        static_assert(sizeof...(index) > 0, "shuffle must select at least one element");
+        static_assert(((index < size) && ...), "shuffle index out of range");
+        constexpr size_t out_size = sizeof...(index);
+        Vector<T, out_size> out;
+        if constexpr (detail::simd::shuffle_enabled<T, size, out_size>) {
+            if (!detail::is_constant_evaluated()) {
+                using S = detail::simd::traits<T, size>;
+                S::store(&out[0], detail::shuffle_register<S, size, index...>(
+                        S::load(&v[0]), std::make_index_sequence<S::storage_size>()));
+                if constexpr (size == S::storage_size) {
+                    // источник без дополнения, например Vector<f4, 4> -> xyz
+                    for (size_t i = out_size; i < S::storage_size; i++) {
+                        (&out[0])[i] = T{};
+                    }
+                }
+                return out;
+            }
+        }
+        detail::apply_sequence<out_size>([](auto i, auto &&v, auto &&out) {
+            out[i] = v[detail::index_list<index...>::value[i]];
+        }, v, out);
+        return out;
+    }
+
     template<typename T, size_t size, typename CharT, typename Traits>
     inline std::basic_ostream<CharT, Traits> &operator<<(
             std::basic_ostream<CharT, Traits> &out, const Vector<T, size> &v) {
@@ -161,44 +266,62 @@ namespace JIO {
         return out;
     }
 
-#define BIN_VV_OPERATOR(op)                                                                \
+#define BIN_VV_OPERATOR(op, simd_fn)                                                       \
     template<typename T1, typename T2, size_t size>                                        \
     constexpr auto operator op(const Vector<T1, size>& v1, const Vector<T2, size>& v2) {   \
-        Vector<decltype(std::declval<T1>() op std::declval<T2>()), size> out;              \
+        using R = decltype(std::declval<T1>() op std::declval<T2>());                      \
+        Vector<R, size> out;                                                               \
+        if constexpr (detail::simd::enabled<detail::simd::has_##simd_fn, R, size, T1, T2>) { \
+            if (!detail::is_constant_evaluated()) {                                        \
+                using S = detail::simd::traits<R, size>;                                   \
+                S::store(&out[0], S::simd_fn(S::load(&v1[0]), S::load(&v2[0])));          \
+                return out;                                                                \
+            }                                                                              \
+        }                                                                                  \
         detail::apply_sequence<size>([](auto index, auto&& v1, auto&& v2, auto&& out) {    \
             out[index] = v1[index] op v2[index];                                           \
             }, v1, v2, out);                                                               \
         return out;                                                                        \
     }
 
-    BIN_VV_OPERATOR(+)
+    BIN_VV_OPERATOR(+, add)
 
-    BIN_VV_OPERATOR(-)
+    BIN_VV_OPERATOR(-, sub)
 
-    BIN_VV_OPERATOR(*)
+    BIN_VV_OPERATOR(*, mul)
 
-    BIN_VV_OPERATOR(/)
+    BIN_VV_OPERATOR(/, div)
 
-    BIN_VV_OPERATOR(%)
+    BIN_VV_OPERATOR(%, none)
 
-    BIN_VV_OPERATOR(|)
+    BIN_VV_OPERATOR(|, bor)
 
-    BIN_VV_OPERATOR(&)
+    BIN_VV_OPERATOR(&, band)
 
-    BIN_VV_OPERATOR(^)
+    BIN_VV_OPERATOR(^, bxor)
 
-    BIN_VV_OPERATOR(&&)
+    BIN_VV_OPERATOR(&&, none)
 
-    BIN_VV_OPERATOR(||)
+    BIN_VV_OPERATOR(||, none)
 
-    BIN_VV_OPERATOR(<<)
+    BIN_VV_OPERATOR(<<, none)
 
-    BIN_VV_OPERATOR(>>)
+    BIN_VV_OPERATOR(>>, none)
 
-#define BIN_VT_TV_OPERATOR(op)                                                             \
+#define BIN_VT_TV_OPERATOR(op, simd_fn)                                                    \
     template<typename T1, typename T2, size_t size>                                        \
     constexpr auto operator op(const Vector<T1, size>& v1, const T2& v2) {                 \
-        Vector<decltype(std::declval<T1>() op std::declval<T2>()), size> out;              \
+        using R = decltype(std::declval<T1>() op std::declval<T2>());                      \
+        Vector<R, size> out;                                                               \
+        if constexpr (detail::simd::enabled<detail::simd::has_##simd_fn, R, size, T1>      \
+                      && std::is_arithmetic_v<T2>) {                                       \
+            if (!detail::is_constant_evaluated()) {                                        \
+                using S = detail::simd::traits<R, size>;                                   \
+                S::store(&out[0], S::simd_fn(S::load(&v1[0]),                              \
+                                             S::set1(static_cast<R>(v2))));                \
+                return out;                                                                \
+            }                                                                              \
+        }                                                                                  \
         detail::apply_sequence<size>([](auto index, auto&& v1, auto&& v2, auto&& out) {    \
             out[index] = v1[index] op v2;                                                  \
             }, v1, v2, out);                                                               \
@@ -213,103 +336,129 @@ namespace JIO {
         return out;                                                                        \
     }*/
 
-    BIN_VT_TV_OPERATOR(+)
+    BIN_VT_TV_OPERATOR(+, add)
 
-    BIN_VT_TV_OPERATOR(-)
+    BIN_VT_TV_OPERATOR(-, sub)
 
-    BIN_VT_TV_OPERATOR(*)
+    BIN_VT_TV_OPERATOR(*, mul)
 
-    BIN_VT_TV_OPERATOR(/)
+    BIN_VT_TV_OPERATOR(/, div)
 
-    BIN_VT_TV_OPERATOR(%)
+    BIN_VT_TV_OPERATOR(%, none)
 
-    BIN_VT_TV_OPERATOR(|)
+    BIN_VT_TV_OPERATOR(|, bor)
 
-    BIN_VT_TV_OPERATOR(&)
+    BIN_VT_TV_OPERATOR(&, band)
 
-    BIN_VT_TV_OPERATOR(^)
+    BIN_VT_TV_OPERATOR(^, bxor)
 
-    BIN_VT_TV_OPERATOR(&&)
+    BIN_VT_TV_OPERATOR(&&, none)
 
-    BIN_VT_TV_OPERATOR(||)
+    BIN_VT_TV_OPERATOR(||, none)
 
-    BIN_VT_TV_OPERATOR(<<)
+    BIN_VT_TV_OPERATOR(<<, none)
 
-    BIN_VT_TV_OPERATOR(>>)
+    BIN_VT_TV_OPERATOR(>>, none)
 
-#define UNARY_V_OPERATOR(op)                                                   \
+#define UNARY_V_OPERATOR(op, simd_fn)                                          \
     template<typename T, size_t size>                                          \
     constexpr auto operator op(const Vector<T, size>& v) {                     \
-        Vector<decltype(op std::declval<T>()), size> out;                      \
+        using R = decltype(op std::declval<T>());                              \
+        Vector<R, size> out;                                                   \
+        if constexpr (detail::simd::enabled<detail::simd::has_##simd_fn, R, size, T>) { \
+            if (!detail::is_constant_evaluated()) {                            \
+                using S = detail::simd::traits<R, size>;                       \
+                S::store(&out[0], S::simd_fn(S::load(&v[0])));                 \
+                return out;                                                    \
+            }                                                                  \
+        }                                                                      \
         detail::apply_sequence<size>([](auto index, auto&& v, auto&& out) {    \
             out[index] = op v[index];                                          \
             }, v, out);                                                        \
         return out;                                                            \
     }
 
-    UNARY_V_OPERATOR(+)
+    UNARY_V_OPERATOR(+, none)
 
-    UNARY_V_OPERATOR(-)
+    UNARY_V_OPERATOR(-, neg)
 
-    UNARY_V_OPERATOR(~)
+    UNARY_V_OPERATOR(~, none)
 
-#define ASSIGN_VV_OPERATOR(op)                                                                  \
+#define ASSIGN_VV_OPERATOR(op, simd_fn)                                                         \
     template<typename T1, typename T2, size_t size>                                             \
     constexpr Vector<T1, size>& operator op(Vector<T1, size>& v1, const Vector<T2, size>& v2) { \
+        if constexpr (detail::simd::enabled<detail::simd::has_##simd_fn, T1, size, T2>) {       \
+            if (!detail::is_constant_evaluated()) {                                             \
+                using S = detail::simd::traits<T1, size>;                                       \
+                S::store(&v1[0], S::simd_fn(S::load(&v1[0]), S::load(&v2[0])));                \
+                return v1;                                                                      \
+            }                                                                                   \
+        }                                                                                       \
         detail::apply_sequence<size>([](auto index, auto&& v1, auto&& v2) {                     \
             v1[index] op v2[index];                                                             \
             }, v1, v2);                                                                         \
         return v1;                                                                              \
     }
 
-    ASSIGN_VV_OPERATOR(+=)
+    ASSIGN_VV_OPERATOR(+=, add)
 
-    ASSIGN_VV_OPERATOR(-=)
+    ASSIGN_VV_OPERATOR(-=, sub)
 
-    ASSIGN_VV_OPERATOR(*=)
+    ASSIGN_VV_OPERATOR(*=, mul)
 
-    ASSIGN_VV_OPERATOR(/=)
+    ASSIGN_VV_OPERATOR(/=, div)
 
-    ASSIGN_VV_OPERATOR(%=)
+    ASSIGN_VV_OPERATOR(%=, none)
 
-    ASSIGN_VV_OPERATOR(|=)
+    ASSIGN_VV_OPERATOR(|=, bor)
 
-    ASSIGN_VV_OPERATOR(&=)
+    ASSIGN_VV_OPERATOR(&=, band)
 
-    ASSIGN_VV_OPERATOR(^=)
+    ASSIGN_VV_OPERATOR(^=, bxor)
 
-    ASSIGN_VV_OPERATOR(<<=)
+    ASSIGN_VV_OPERATOR(<<=, none)
 
-    ASSIGN_VV_OPERATOR(>>=)
+    ASSIGN_VV_OPERATOR(>>=, none)
 
-#define ASSIGN_VT_OPERATOR(op)                                                    \
-    template<typename T1, typename T2, size_t size>                               \
-    constexpr Vector<T1, size>& operator op(Vector<T1, size>& v1, const T2& v2) { \
-        detail::apply_sequence<size>([](auto index, auto&& v1, auto&& v2) {       \
-            v1[index] op v2;                                                      \
-            }, v1, v2);                                                           \
-        return v1;                                                                \
+#define ASSIGN_VT_OPERATOR(op, simd_fn)                                                    \
+    template<typename T1, typename T2, size_t size>                                        \
+    constexpr Vector<T1, size>& operator op(Vector<T1, size>& v1, const T2& v2) {          \
+        if constexpr (detail::simd::enabled<detail::simd::has_##simd_fn, T1, size>         \
+                      && std::is_arithmetic_v<T2>) {                                       \
+            if constexpr (std::is_same_v<std::common_type_t<T1, T2>, T1>) {                \
+                if (!detail::is_constant_evaluated()) {                                    \
+                    using S = detail::simd::traits<T1, size>;                              \
+                    S::store(&v1[0], S::simd_fn(S::load(&v1[0]),                           \
+                                                S::set1(static_cast<T1>(v2))));            \
+                    return v1;                                                             \
+                }                                                                          \
+            }                                                                              \
+        }                                                                                  \
+        detail::apply_sequence<size>([](auto index, auto&& v1, auto&& v2) {                \
+            v1[index] op v2;                                                               \
+            }, v1, v2);                                                                    \
+        return v1;                                                                         \
     }
 
-    ASSIGN_VT_OPERATOR(+=)
+    ASSIGN_VT_OPERATOR(+=, add)
 
-    ASSIGN_VT_OPERATOR(-=)
+    ASSIGN_VT_OPERATOR(-=, sub)
 
-    ASSIGN_VT_OPERATOR(*=)
+    ASSIGN_VT_OPERATOR(*=, mul)
 
-    ASSIGN_VT_OPERATOR(/=)
+    ASSIGN_VT_OPERATOR(/=, div)
 
-    ASSIGN_VT_OPERATOR(%=)
+    ASSIGN_VT_OPERATOR(%=, none)
 
-    ASSIGN_VT_OPERATOR(|=)
+    ASSIGN_VT_OPERATOR(|=, bor)
 
-    ASSIGN_VT_OPERATOR(&=)
+    ASSIGN_VT_OPERATOR(&=, band)
 
-    ASSIGN_VT_OPERATOR(^=)
+    ASSIGN_VT_OPERATOR(^=, bxor)
 
-    ASSIGN_VT_OPERATOR(<<=)
+    ASSIGN_VT_OPERATOR(<<=, none)
 
-    ASSIGN_VT_OPERATOR(>>=)
+    ASSIGN_VT_OPERATOR(>>=, none)
 
 #define BIN_VV_F(name, fn)                                                              \
     template<typename T1, typename T2, size_t size>                                     \
@@ -321,33 +470,41 @@ namespace JIO {
         return out;                                                                     \
     }
 
-#define UNARY_V_F(name, fn)                                                 \
+#define UNARY_V_F(name, fn, simd_fn)                                        \
     template<typename T, size_t size>                                       \
     constexpr auto name(const Vector<T, size>& v) {                         \
-        Vector<decltype(fn(std::declval<T>())), size> out;                  \
+        using R = decltype(fn(std::declval<T>()));                          \
+        Vector<R, size> out;                                                \
+        if constexpr (detail::simd::enabled<detail::simd::has_##simd_fn, R, size, T>) { \
+            if (!detail::is_constant_evaluated()) {                         \
+                using S = detail::simd::traits<R, size>;                    \
+                S::store(&out[0], S::simd_fn(S::load(&v[0])));              \
+                return out;                                                 \
+            }                                                               \
+        }                                                                   \
         detail::apply_sequence<size>([](auto index, auto&& v, auto&& out) { \
             out[index] = fn(v[index]);                                      \
             }, v, out);                                                     \
         return out;                                                         \
     }
 
-    UNARY_V_F(abs, std::abs)
+    UNARY_V_F(abs, std::abs, abs)
 
-    UNARY_V_F(sqrt, std::sqrt)
+    UNARY_V_F(sqrt, std::sqrt, sqrt)
 
-    UNARY_V_F(sin, std::sin)
+    UNARY_V_F(sin, std::sin, none)
 
-    UNARY_V_F(cos, std::cos)
+    UNARY_V_F(cos, std::cos, none)
 
-    UNARY_V_F(tan, std::tan)
+    UNARY_V_F(tan, std::tan, none)
 
-    UNARY_V_F(asin, std::asin)
+    UNARY_V_F(asin, std::asin, none)
 
-    UNARY_V_F(acos, std::acos)
+    UNARY_V_F(acos, std::acos, none)
 
-    UNARY_V_F(atan, std::atan)
+    UNARY_V_F(atan, std::atan, none)
 
-    UNARY_V_F(floor, std::floor)
+    UNARY_V_F(floor, std::floor, floor)
 
     //TODO: simplify?
     template<typename T, std::enable_if_t<std::is_arithmetic_v<T>, bool> = true>
@@ -355,11 +512,17 @@ namespace JIO {
         return v - std::floor(v);
     }
 
-    UNARY_V_F(fract, fract)
+    UNARY_V_F(fract, fract, none)
 
     template<typename T1, typename T2, size_t size>
     constexpr auto dot(const Vector<T1, size> &v1, const Vector<T2, size> &v2) {
         using R = decltype(std::declval<T1>() * std::declval<T2>());
+        if constexpr (detail::simd::enabled<detail::simd::has_dot, R, size, T1, T2>) {
+            if (!detail::is_constant_evaluated()) {
+                using S = detail::simd::traits<R, size>;
+                return S::dot(S::load(&v1[0]), S::load(&v2[0]));
+            }
+        }
         R out = R{};
         detail::apply_sequence<size>([](auto index, auto &&v1, auto &&v2, auto &&out) {
             out += v1[index] * v2[index];
@@ -367,6 +530,13 @@ namespace JIO {
         return out;
     }
 
+    // a * b.yzx - a.yzx * b = (a x b).zxy
+    template<typename T1, typename T2>
+    constexpr auto cross(const Vector<T1, 3> &v1, const Vector<T2, 3> &v2) {
+        auto tmp = v1 * v2.yzx() - v1.yzx() * v2;
+        return tmp.yzx();
+    }
+
     template<typename T, size_t size>
     constexpr T length(const Vector<T, size> &v) {
         return std::sqrt(dot(v, v));
@@ -394,6 +564,15 @@ namespace JIO {
     constexpr auto clamp(const Vector<T1, size> &v, const T2 &lo2, const T3 &hi3) {
         T1 lo = static_cast<T1>(lo2), hi = static_cast<T1>(hi3);
         Vector<T1, size> out;
+        if constexpr (detail::simd::enabled<detail::simd::has_min, T1, size>
+                      && detail::simd::enabled<detail::simd::has_max, T1, size>) {
+            if (!detail::is_constant_evaluated()) {
+                using S = detail::simd::traits<T1, size>;
+                // NaN проходит насквозь, как и в скалярной ветви
+                S::store(&out[0], S::max(S::set1(lo), S::min(S::set1(hi), S::load(&v[0]))));
+                return out;
+            }
+        }
         detail::apply_sequence<size>([](auto index, auto &&v, auto hi, auto lo, auto &&out) {
             T1 value = v[index];
             out[index] = value < lo ? lo : (value > hi ? hi : value);
@@ -404,6 +583,19 @@ namespace JIO {
     template<typename T1, size_t size, typename T2>
     constexpr auto mix(const Vector<T1, size> &v1, const Vector<T1, size> &v2, const T2 &m) {
         Vector<T1, size> out;
+        if constexpr (detail::simd::enabled<detail::simd::has_mul, T1, size>
+                      && detail::simd::enabled<detail::simd::has_add, T1, size>
+                      && std::is_arithmetic_v<T2>) {
+            if constexpr (std::is_same_v<std::common_type_t<T1, T2>, T1>) {
+                if (!detail::is_constant_evaluated()) {
+                    using S = detail::simd::traits<T1, size>;
+                    auto a = S::load(&v1[0]);
+                    auto d = S::sub(a, S::load(&v2[0]));
+                    S::store(&out[0], S::add(a, S::mul(d, S::set1(static_cast<T1>(m)))));
+                    return out;
+                }
+            }
+        }
         detail::apply_sequence<size>([](auto index, auto &&v1, auto &&v2, auto m, auto &&out) {
             out[index] = v1[index] + (v1[index] - v2[index]) * m;
         }, v1, v2, m, out);
@@ -0,0 +1,461 @@
+/*
+ * Copyright (c) 2023 Vladimir Kozelkov
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef VECTOR_ARRAY_HPP
+#define VECTOR_ARRAY_HPP
+
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <utility>
+#include "Vector.hpp"
+#include "../exceptions.hpp"
+
+// -std=c++17
+namespace JIO {
+
+    inline namespace detail {
+
+        namespace simd {
+
+            /*
+             * Столбцы VectorArray обрабатываются регистрами шириной 32 байта
+             * (или парами 16-байтных регистров без AVX).
+             */
+            template<typename T>
+            constexpr size_t batch_lanes = sizeof(T) <= 32 ? 32 / sizeof(T) : 1;
+
+            template<typename T>
+            using batch_traits = traits<T, batch_lanes<T>>;
+
+            template<typename T, template<typename, typename> class... has>
+            constexpr bool batch_enabled = (has<batch_traits<T>, void>::value && ...);
+
+        } // namespace simd
+
+        inline void checkBatchSize(size_t size, size_t expected) {
+            if (size != expected) {
+                throw IllegalArgumentException("Array size ", size,
+                        " does not match ", expected);
+            }
+        }
+
+        template<typename T>
+        struct batch_column {
+            const T *data;
+
+            template<typename S>
+            auto load(size_t index) const {
+                return S::load(data + index);
+            }
+
+            T get(size_t index) const {
+                return data[index];
+            }
+        };
+
+        template<typename T>
+        struct batch_scalar {
+            T value;
+
+            template<typename S>
+            auto load(size_t) const {
+                return S::set1(value);
+            }
+
+            T get(size_t) const {
+                return value;
+            }
+        };
+
+        /*
+         * out[i] = fs(args.get(i)...) для i из [0, length). Если simd
+         * истинно, то все блоки по batch_lanes<T> элементов считаются
+         * через fv над регистрами, а скалярно - только хвост. Первым
+         * аргументом fv получает batch_traits<T>.
+         */
+        template<bool simd, typename T, typename FV, typename FS, typename... Args>
+        inline void batch_map(T *out, size_t length, FV &&fv, FS &&fs, Args... args) {
+            size_t i = 0;
+            if constexpr (simd) {
+                using S = simd::batch_traits<T>;
+                constexpr size_t lanes = simd::batch_lanes<T>;
+                for (; i + lanes <= length; i += lanes) {
+                    S::store(out + i, fv(S{}, args.template load<S>(i)...));
+                }
+            }
+            for (; i < length; i++) {
+                out[i] = fs(args.get(i)...);
+            }
+        }
+
+    } // namespace detail
+
+    /*
+     * Массив из size() векторов Vector<T, N>, хранящийся по столбцам:
+     * i-е компоненты всех векторов лежат подряд в column(i). Каждый
+     * столбец выровнен по VectorArray::alignment.
+     *
+     * Пакетные операции ниже работают над целыми столбцами. Все массивы-
+     * аргументы должны иметь тот же размер, что и результат, иначе
+     * бросается IllegalArgumentException; результат может совпадать
+     * с аргументом.
+     */
+    template<typename T, size_t N>
+    class VectorArray {
+        static_assert(N > 0, "vector size must be greater than 0");
+        static_assert(std::is_trivially_copyable_v<T>, "T must be trivially copyable");
+
+    public:
+        static constexpr size_t alignment = 64;
+
+    private:
+        struct aligned_delete {
+            void operator()(T *ptr) const {
+                ::operator delete(ptr, std::align_val_t(alignment));
+            }
+        };
+
+        size_t _size;
+        size_t stride;
+        std::unique_ptr<T, aligned_delete> data;
+
+        static size_t strideOf(size_t size) {
+            constexpr size_t step = alignment / sizeof(T) > 0 ? alignment / sizeof(T) : 1;
+            return (size + step - 1) / step * step;
+        }
+
+        static T *allocate(size_t stride) {
+            if (stride == 0) {
+                return nullptr;
+            }
+            void *ptr = ::operator new(stride * N * sizeof(T), std::align_val_t(alignment));
+            std::memset(ptr, 0, stride * N * sizeof(T));
+            return static_cast<T *>(ptr);
+        }
+
+    public:
+        explicit VectorArray(size_t size = 0) :
+                _size(size), stride(strideOf(size)), data(allocate(stride)) {}
+
+        VectorArray(const VectorArray &other) : VectorArray(other._size) {
+            if (stride != 0) {
+                std::memcpy(data.get(), other.data.get(), stride * N * sizeof(T));
+            }
+        }
+
+        VectorArray(VectorArray &&other) noexcept:
+                _size(std::exchange(other._size, 0)),
+                stride(std::exchange(other.stride, 0)),
+                data(std::move(other.data)) {}
+
+        VectorArray &operator=(const VectorArray &other) {
+            if (this != &other) {
+                *this = VectorArray(other);
+            }
+            return *this;
+        }
+
+        VectorArray &operator=(VectorArray &&other) noexcept {
+            _size = std::exchange(other._size, 0);
+            stride = std::exchange(other.stride, 0);
+            data = std::move(other.data);
+            return *this;
+        }
+
+        size_t size() const {
+            return _size;
+        }
+
+        T *column(size_t index) {
+            return data.get() + index * stride;
+        }
+
+        const T *column(size_t index) const {
+            return data.get() + index * stride;
+        }
+
+        Vector<T, N> get(size_t index) const {
+            Vector<T, N> out;
+            for (size_t i = 0; i < N; i++) {
+                out[i] = column(i)[index];
+            }
+            return out;
+        }
+
+        void set(size_t index, const Vector<T, N> &v) {
+            for (size_t i = 0; i < N; i++) {
+                column(i)[index] = v[i];
+            }
+        }
+
+        void fill(const Vector<T, N> &v) {
+            for (size_t i = 0; i < N; i++) {
+                std::fill_n(column(i), _size, v[i]);
+            }
+        }
+
+        /**
+         * Изменяет размер с сохранением первых min(size(), newSize)
+         * векторов. Новые векторы нулевые.
+         */
+        void resize(size_t newSize) {
+            VectorArray tmp(newSize);
+            size_t count = std::min(_size, newSize);
+            for (size_t i = 0; i < N && count != 0; i++) {
+                std::memcpy(tmp.column(i), column(i), count * sizeof(T));
+            }
+            *this = std::move(tmp);
+        }
+    };
+
+#define BATCH_OPERATOR(op, assign_op, simd_fn)                                                 \
+    template<typename T, size_t N>                                                             \
+    VectorArray<T, N> &operator assign_op(VectorArray<T, N> &v1, const VectorArray<T, N> &v2) { \
+        detail::checkBatchSize(v2.size(), v1.size());                                          \
+        for (size_t i = 0; i < N; i++) {                                                       \
+            detail::batch_map<detail::simd::batch_enabled<T, detail::simd::has_##simd_fn>>(    \
+                    v1.column(i), v1.size(),                                                   \
+                    [](auto s, auto a, auto b) { return decltype(s)::simd_fn(a, b); },         \
+                    [](T a, T b) { return static_cast<T>(a op b); },                           \
+                    detail::batch_column<T>{v1.column(i)},                                     \
+                    detail::batch_column<T>{v2.column(i)});                                    \
+        }                                                                                      \
+        return v1;                                                                             \
+    }                                                                                          \
+    template<typename T, size_t N>                                                             \
+    VectorArray<T, N> &operator assign_op(VectorArray<T, N> &v1, const Vector<T, N> &v2) {     \
+        for (size_t i = 0; i < N; i++) {                                                       \
+            detail::batch_map<detail::simd::batch_enabled<T, detail::simd::has_##simd_fn>>(    \
+                    v1.column(i), v1.size(),                                                   \
+                    [](auto s, auto a, auto b) { return decltype(s)::simd_fn(a, b); },         \
+                    [](T a, T b) { return static_cast<T>(a op b); },                           \
+                    detail::batch_column<T>{v1.column(i)},                                     \
+                    detail::batch_scalar<T>{v2[i]});                                           \
+        }                                                                                      \
+        return v1;                                                                             \
+    }                                                                                          \
+    template<typename T, size_t N, typename T2,                                                \
+            std::enable_if_t<std::is_arithmetic_v<T2>, bool> = true>                           \
+    VectorArray<T, N> &operator assign_op(VectorArray<T, N> &v1, const T2 &v2) {               \
+        return v1 assign_op Vector<T, N>(v2);                                                  \
+    }                                                                                          \
+    template<typename T, size_t N, typename T2>                                                \
+    VectorArray<T, N> operator op(const VectorArray<T, N> &v1, const T2 &v2) {                 \
+        VectorArray<T, N> out(v1);                                                             \
+        out assign_op v2;                                                                      \
+        return out;                                                                            \
+    }
+
+    BATCH_OPERATOR(+, +=, add)
+
+    BATCH_OPERATOR(-, -=, sub)
+
+    BATCH_OPERATOR(*, *=, mul)
+
+    BATCH_OPERATOR(/, /=, div)
+
+#undef BATCH_OPERATOR
+
+#define BATCH_UNARY_F(name, fn, simd_fn)                                                       \
+    template<typename T, size_t N>                                                             \
+    void name(const VectorArray<T, N> &v, VectorArray<T, N> &out) {                            \
+        detail::checkBatchSize(v.size(), out.size());                                          \
+        for (size_t i = 0; i < N; i++) {                                                       \
+            detail::batch_map<detail::simd::batch_enabled<T, detail::simd::has_##simd_fn>>(    \
+                    out.column(i), out.size(),                                                 \
+                    [](auto s, auto a) { return decltype(s)::simd_fn(a); },                    \
+                    [](T a) { return static_cast<T>(fn(a)); },                                 \
+                    detail::batch_column<T>{v.column(i)});                                     \
+        }                                                                                      \
+    }                                                                                          \
+    template<typename T, size_t N>                                                             \
+    VectorArray<T, N> name(const VectorArray<T, N> &v) {                                       \
+        VectorArray<T, N> out(v.size());                                                       \
+        name(v, out);                                                                          \
+        return out;                                                                            \
+    }
+
+    BATCH_UNARY_F(negate, -, neg)
+
+    BATCH_UNARY_F(abs, std::abs, abs)
+
+    BATCH_UNARY_F(sqrt, std::sqrt, sqrt)
+
+    BATCH_UNARY_F(floor, std::floor, floor)
+
+#undef BATCH_UNARY_F
+
+    template<typename T, size_t N>
+    VectorArray<T, N> operator-(const VectorArray<T, N> &v) {
+        return negate(v);
+    }
+
+    /*
+     * Скалярные произведения по парам векторов. Компоненты складываются
+     * по порядку, поэтому для вещественных T результат может отличаться
+     * от dot для Vector в последних битах: там SIMD-ветвь суммирует
+     * попарно, а компилятор может слить умножение со сложением в FMA
+     * (-ffp-contract=fast, по умолчанию в GCC).
+     */
+    template<typename T, size_t N>
+    void dot(const VectorArray<T, N> &v1, const VectorArray<T, N> &v2, VectorArray<T, 1> &out) {
+        size_t i = 0, length = out.size();
+        detail::checkBatchSize(v1.size(), length);
+        detail::checkBatchSize(v2.size(), length);
+        T *dst = out.column(0);
+        if constexpr (detail::simd::batch_enabled<T, detail::simd::has_add, detail::simd::has_mul>) {
+            using S = detail::simd::batch_traits<T>;
+            constexpr size_t lanes = detail::simd::batch_lanes<T>;
+            for (; i + lanes <= length; i += lanes) {
+                auto acc = S::mul(S::load(v1.column(0) + i), S::load(v2.column(0) + i));
+                for (size_t c = 1; c < N; c++) {
+                    acc = S::add(acc, S::mul(S::load(v1.column(c) + i), S::load(v2.column(c) + i)));
+                }
+                S::store(dst + i, acc);
+            }
+        }
+        for (; i < length; i++) {
+            T acc = v1.column(0)[i] * v2.column(0)[i];
+            for (size_t c = 1; c < N; c++) {
+                acc += v1.column(c)[i] * v2.column(c)[i];
+            }
+            dst[i] = acc;
+        }
+    }
+
+    template<typename T, size_t N>
+    VectorArray<T, 1> dot(const VectorArray<T, N> &v1, const VectorArray<T, N> &v2) {
+        VectorArray<T, 1> out(v1.size());
+        dot(v1, v2, out);
+        return out;
+    }
+
+    template<typename T, size_t N>
+    void length(const VectorArray<T, N> &v, VectorArray<T, 1> &out) {
+        dot(v, v, out);
+        sqrt(out, out);
+    }
+
+    template<typename T, size_t N>
+    VectorArray<T, 1> length(const VectorArray<T, N> &v) {
+        VectorArray<T, 1> out(v.size());
+        length(v, out);
+        return out;
+    }
+
+    template<typename T, size_t N, typename T2, typename T3>
+    void clamp(const VectorArray<T, N> &v, const T2 &lo2, const T3 &hi3, VectorArray<T, N> &out) {
+        T lo = static_cast<T>(lo2), hi = static_cast<T>(hi3);
+        detail::checkBatchSize(v.size(), out.size());
+        for (size_t i = 0; i < N; i++) {
+            detail::batch_map<detail::simd::batch_enabled<
+                    T, detail::simd::has_min, detail::simd::has_max>>(
+                    out.column(i), out.size(),
+                    [](auto s, auto value, auto lo, auto hi) {
+                        using S = decltype(s);
+                        return S::max(lo, S::min(hi, value));
+                    },
+                    [](T value, T lo, T hi) {
+                        return value < lo ? lo : (value > hi ? hi : value);
+                    },
+                    detail::batch_column<T>{v.column(i)},
+                    detail::batch_scalar<T>{lo}, detail::batch_scalar<T>{hi});
+        }
+    }
+
+    template<typename T, size_t N, typename T2, typename T3>
+    VectorArray<T, N> clamp(const VectorArray<T, N> &v, const T2 &lo, const T3 &hi) {
+        VectorArray<T, N> out(v.size());
+        clamp(v, lo, hi, out);
+        return out;
+    }
+
+    template<typename T, size_t N, typename T2>
+    void mix(const VectorArray<T, N> &v1, const VectorArray<T, N> &v2, const T2 &m2,
+             VectorArray<T, N> &out) {
+        T m = static_cast<T>(m2);
+        detail::checkBatchSize(v1.size(), out.size());
+        detail::checkBatchSize(v2.size(), out.size());
+        for (size_t i = 0; i < N; i++) {
+            detail::batch_map<detail::simd::batch_enabled<
+                    T, detail::simd::has_add, detail::simd::has_sub, detail::simd::has_mul>>(
+                    out.column(i), out.size(),
+                    [](auto s, auto a, auto b, auto m) {
+                        using S = decltype(s);
+                        return S::add(a, S::mul(S::sub(a, b), m));
+                    },
+                    [](T a, T b, T m) { return static_cast<T>(a + (a - b) * m); },
+                    detail::batch_column<T>{v1.column(i)},
+                    detail::batch_column<T>{v2.column(i)}, detail::batch_scalar<T>{m});
+        }
+    }
+
+    template<typename T, size_t N, typename T2>
+    VectorArray<T, N> mix(const VectorArray<T, N> &v1, const VectorArray<T, N> &v2, const T2 &m) {
+        VectorArray<T, N> out(v1.size());
+        mix(v1, v2, m, out);
+        return out;
+    }
+
+    template<typename T, size_t N, typename T2, typename T3, typename T4, typename T5>
+    void remap(const VectorArray<T, N> &v, const T2 &lo_in2, const T3 &hi_in3,
+               const T4 &lo_out4, const T5 &hi_out5, VectorArray<T, N> &out) {
+        T lo_in = static_cast<T>(lo_in2), hi_in = static_cast<T>(hi_in3);
+        T lo_out = static_cast<T>(lo_out4), hi_out = static_cast<T>(hi_out5);
+        T range_out = hi_out - lo_out, range_in = hi_in - lo_in;
+        detail::checkBatchSize(v.size(), out.size());
+        for (size_t i = 0; i < N; i++) {
+            detail::batch_map<detail::simd::batch_enabled<T,
+                    detail::simd::has_min, detail::simd::has_max, detail::simd::has_add,
+                    detail::simd::has_sub, detail::simd::has_mul, detail::simd::has_div>>(
+                    out.column(i), out.size(),
+                    [](auto s, auto value, auto lo_in, auto hi_in, auto lo_out,
+                       auto range_out, auto range_in) {
+                        using S = decltype(s);
+                        value = S::max(lo_in, S::min(hi_in, value));
+                        value = S::div(S::mul(S::sub(value, lo_in), range_out), range_in);
+                        return S::add(value, lo_out);
+                    },
+                    [](T value, T lo_in, T hi_in, T lo_out, T range_out, T range_in) {
+                        value = value < lo_in ? lo_in : (value > hi_in ? hi_in : value);
+                        return static_cast<T>((value - lo_in) * range_out / range_in + lo_out);
+                    },
+                    detail::batch_column<T>{v.column(i)},
+                    detail::batch_scalar<T>{lo_in}, detail::batch_scalar<T>{hi_in},
+                    detail::batch_scalar<T>{lo_out}, detail::batch_scalar<T>{range_out},
+                    detail::batch_scalar<T>{range_in});
+        }
+    }
+
+    template<typename T, size_t N, typename T2, typename T3, typename T4, typename T5>
+    VectorArray<T, N> remap(const VectorArray<T, N> &v, const T2 &lo_in, const T3 &hi_in,
+                            const T4 &lo_out, const T5 &hi_out) {
+        VectorArray<T, N> out(v.size());
+        remap(v, lo_in, hi_in, lo_out, hi_out, out);
+        return out;
+    }
+
+} // namespace JIO
+
+#endif /* VECTOR_ARRAY_HPP */
@@ -0,0 +1,844 @@
+/*
+ * Copyright (c) 2023 Vladimir Kozelkov
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef VECTOR_SIMD_HPP
+#define VECTOR_SIMD_HPP
+
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+#include "../jtypes.hpp"
+
+#if defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+// -std=c++17
+namespace JIO {
+
+    inline namespace detail {
+
+#if defined(__has_builtin)
+#if __has_builtin(__builtin_is_constant_evaluated)
+#define JIO_HAS_IS_CONSTANT_EVALUATED
+#endif
+#elif defined(__GNUC__) && __GNUC__ >= 9
+#define JIO_HAS_IS_CONSTANT_EVALUATED
+#endif
+
+        /*
+         * SIMD-ветви операций Vector выполняются только вне константных
+         * вычислений. Без встроенной функции компилятора всегда
+         * используется скалярный код.
+         */
+        constexpr bool is_constant_evaluated() noexcept {
+#if defined(JIO_HAS_IS_CONSTANT_EVALUATED)
+            return __builtin_is_constant_evaluated();
+#else
+            return true;
+#endif
+        }
+
+        namespace simd {
+
+            /*
+             * Хранение data в Vector<T, size>. Не зависит от флагов
+             * компиляции, чтобы раскладка Vector совпадала в единицах
+             * трансляции, собранных с разными наборами инструкций.
+             */
+            template<typename T, size_t size>
+            struct layout {
+                static constexpr size_t storage_size = size;
+                static constexpr size_t alignment = alignof(T);
+            };
+
+#define SIMD_LAYOUT(T, size, storage, align)                                 \
+            template<>                                                       \
+            struct layout<T, size> {                                         \
+                static constexpr size_t storage_size = storage;              \
+                static constexpr size_t alignment = align;                   \
+            };
+
+            SIMD_LAYOUT(f4, 3, 4, 16)
+
+            SIMD_LAYOUT(f4, 4, 4, 16)
+
+            SIMD_LAYOUT(f4, 8, 8, 32)
+
+            SIMD_LAYOUT(f8, 2, 2, 16)
+
+            SIMD_LAYOUT(f8, 4, 4, 32)
+
+            SIMD_LAYOUT(s4, 4, 4, 16)
+
+            SIMD_LAYOUT(s4, 8, 8, 32)
+
+#undef SIMD_LAYOUT
+
+            /*
+             * Описание регистрового представления Vector<T, size>: набор
+             * статических функций - операции, доступные в SIMD-ветвях.
+             * Отсутствующая функция означает скалярную ветвь.
+             */
+            template<typename T, size_t size>
+            struct traits : layout<T, size> { };
+
+            /*
+             * Вектор двойной ширины из двух половин, если нужный набор
+             * инструкций недоступен.
+             */
+            template<typename H>
+            struct pair_traits {
+                using value_type = typename H::value_type;
+
+                struct reg {
+                    typename H::reg lo, hi;
+                };
+
+                static reg load(const value_type *p) {
+                    return {H::load(p), H::load(p + H::storage_size)};
+                }
+
+                static void store(value_type *p, reg v) {
+                    H::store(p, v.lo);
+                    H::store(p + H::storage_size, v.hi);
+                }
+
+                static reg set1(value_type v) {
+                    return {H::set1(v), H::set1(v)};
+                }
+
+#define PAIR_BINARY(name)                                                    \
+                template<typename HH = H>                                    \
+                static auto name(reg a, reg b)                               \
+                        -> decltype(HH::name(a.lo, b.lo), reg()) {           \
+                    return {HH::name(a.lo, b.lo), HH::name(a.hi, b.hi)};     \
+                }
+
+#define PAIR_UNARY(name)                                                     \
+                template<typename HH = H>                                    \
+                static auto name(reg a) -> decltype(HH::name(a.lo), reg()) { \
+                    return {HH::name(a.lo), HH::name(a.hi)};                 \
+                }
+
+                PAIR_BINARY(add)
+
+                PAIR_BINARY(sub)
+
+                PAIR_BINARY(mul)
+
+                PAIR_BINARY(div)
+
+                PAIR_BINARY(band)
+
+                PAIR_BINARY(bor)
+
+                PAIR_BINARY(bxor)
+
+                PAIR_BINARY(min)
+
+                PAIR_BINARY(max)
+
+                PAIR_UNARY(neg)
+
+                PAIR_UNARY(abs)
+
+                PAIR_UNARY(sqrt)
+
+                PAIR_UNARY(floor)
+
+                PAIR_UNARY(round)
+
+                PAIR_UNARY(rsqrt)
+
+                PAIR_BINARY(greater)
+
+                PAIR_BINARY(copysign)
+
+#undef PAIR_BINARY
+#undef PAIR_UNARY
+
+                template<typename HH = H>
+                static auto dot(reg a, reg b) -> decltype(HH::dot(a.lo, b.lo)) {
+                    return HH::dot(a.lo, b.lo) + HH::dot(a.hi, b.hi);
+                }
+
+                template<typename HH = H>
+                static auto select(reg m, reg a, reg b) -> decltype(HH::select(m.lo, a.lo, b.lo), reg()) {
+                    return {HH::select(m.lo, a.lo, b.lo), HH::select(m.hi, a.hi, b.hi)};
+                }
+            };
+
+#if defined(__SSE2__)
+
+            template<>
+            struct traits<f4, 4> : layout<f4, 4> {
+                using value_type = f4;
+                using reg = __m128;
+
+
+                static reg load(const f4 *p) {
+                    return _mm_load_ps(p);
+                }
+
+                static void store(f4 *p, reg v) {
+                    _mm_store_ps(p, v);
+                }
+
+                static reg set1(f4 v) {
+                    return _mm_set1_ps(v);
+                }
+
+                static reg add(reg a, reg b) {
+                    return _mm_add_ps(a, b);
+                }
+
+                static reg sub(reg a, reg b) {
+                    return _mm_sub_ps(a, b);
+                }
+
+                static reg mul(reg a, reg b) {
+                    return _mm_mul_ps(a, b);
+                }
+
+                static reg div(reg a, reg b) {
+                    return _mm_div_ps(a, b);
+                }
+
+                static reg min(reg a, reg b) {
+                    return _mm_min_ps(a, b);
+                }
+
+                static reg max(reg a, reg b) {
+                    return _mm_max_ps(a, b);
+                }
+
+                static reg neg(reg a) {
+                    return _mm_xor_ps(a, _mm_set1_ps(-0.0f));
+                }
+
+                static reg abs(reg a) {
+                    return _mm_andnot_ps(_mm_set1_ps(-0.0f), a);
+                }
+
+                static reg sqrt(reg a) {
+                    return _mm_sqrt_ps(a);
+                }
+
+                // Элемент i результата - элемент index_i аргумента
+                template<size_t i0, size_t i1, size_t i2, size_t i3>
+                static reg shuffle(reg a) {
+                    return _mm_shuffle_ps(a, a, _MM_SHUFFLE(i3, i2, i1, i0));
+                }
+
+                // Приближение 1/sqrt с относительной ошибкой до 1.5 * 2^-12
+                static reg rsqrt(reg a) {
+                    return _mm_rsqrt_ps(a);
+                }
+
+#if defined(__SSE4_1__)
+
+                static reg floor(reg a) {
+                    return _mm_floor_ps(a);
+                }
+
+                static reg round(reg a) {
+                    return _mm_round_ps(a, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+                }
+
+                static reg select(reg m, reg a, reg b) {
+                    return _mm_blendv_ps(b, a, m);
+                }
+#else
+
+                // Верно для |a| < 2^31
+                static reg round(reg a) {
+                    return _mm_cvtepi32_ps(_mm_cvtps_epi32(a));
+                }
+
+                static reg select(reg m, reg a, reg b) {
+                    return _mm_or_ps(_mm_and_ps(m, a), _mm_andnot_ps(m, b));
+                }
+#endif
+
+                static reg greater(reg a, reg b) {
+                    return _mm_cmpgt_ps(a, b);
+                }
+
+                static reg copysign(reg magnitude, reg sign) {
+                    reg mask = _mm_set1_ps(-0.0f);
+                    return _mm_or_ps(_mm_andnot_ps(mask, magnitude), _mm_and_ps(mask, sign));
+                }
+
+                static f4 hsum(reg a) {
+                    reg shuf = _mm_shuffle_ps(a, a, _MM_SHUFFLE(2, 3, 0, 1));
+                    reg sums = _mm_add_ps(a, shuf);
+                    shuf = _mm_movehl_ps(shuf, sums);
+                    sums = _mm_add_ss(sums, shuf);
+                    return _mm_cvtss_f32(sums);
+                }
+
+                static f4 dot(reg a, reg b) {
+                    return hsum(_mm_mul_ps(a, b));
+                }
+            };
+
+            /*
+             * Vector<f4, 3> дополнен до четырёх элементов. Четвёртый элемент
+             * всегда равен нулю: скаляры расширяются нулём, а делитель
+             * в нём заменяется единицей, чтобы не получать NaN.
+             */
+            template<>
+            struct traits<f4, 3> : traits<f4, 4> {
+                static reg mask() {
+                    return _mm_castsi128_ps(_mm_setr_epi32(-1, -1, -1, 0));
+                }
+
+                static reg set1(f4 v) {
+                    return _mm_setr_ps(v, v, v, 0.0f);
+                }
+
+                static reg div(reg a, reg b) {
+                    b = _mm_or_ps(_mm_and_ps(b, mask()),
+                                  _mm_setr_ps(0.0f, 0.0f, 0.0f, 1.0f));
+                    return _mm_div_ps(a, b);
+                }
+
+                static f4 dot(reg a, reg b) {
+                    return hsum(_mm_and_ps(_mm_mul_ps(a, b), mask()));
+                }
+            };
+
+#if defined(__AVX__)
+
+            template<>
+            struct traits<f4, 8> : layout<f4, 8> {
+                using value_type = f4;
+                using reg = __m256;
+
+
+                static reg load(const f4 *p) {
+                    return _mm256_load_ps(p);
+                }
+
+                static void store(f4 *p, reg v) {
+                    _mm256_store_ps(p, v);
+                }
+
+                static reg set1(f4 v) {
+                    return _mm256_set1_ps(v);
+                }
+
+                static reg add(reg a, reg b) {
+                    return _mm256_add_ps(a, b);
+                }
+
+                static reg sub(reg a, reg b) {
+                    return _mm256_sub_ps(a, b);
+                }
+
+                static reg mul(reg a, reg b) {
+                    return _mm256_mul_ps(a, b);
+                }
+
+                static reg div(reg a, reg b) {
+                    return _mm256_div_ps(a, b);
+                }
+
+                static reg min(reg a, reg b) {
+                    return _mm256_min_ps(a, b);
+                }
+
+                static reg max(reg a, reg b) {
+                    return _mm256_max_ps(a, b);
+                }
+
+                static reg neg(reg a) {
+                    return _mm256_xor_ps(a, _mm256_set1_ps(-0.0f));
+                }
+
+                static reg abs(reg a) {
+                    return _mm256_andnot_ps(_mm256_set1_ps(-0.0f), a);
+                }
+
+                static reg sqrt(reg a) {
+                    return _mm256_sqrt_ps(a);
+                }
+
+#if defined(__AVX2__)
+
+                template<size_t i0, size_t i1, size_t i2, size_t i3,
+                        size_t i4, size_t i5, size_t i6, size_t i7>
+                static reg shuffle(reg a) {
+                    return _mm256_permutevar8x32_ps(a, _mm256_setr_epi32(i0, i1, i2, i3, i4, i5, i6, i7));
+                }
+#endif
+
+                static reg rsqrt(reg a) {
+                    return _mm256_rsqrt_ps(a);
+                }
+
+                static reg floor(reg a) {
+                    return _mm256_floor_ps(a);
+                }
+
+                static reg round(reg a) {
+                    return _mm256_round_ps(a, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+                }
+
+                static reg greater(reg a, reg b) {
+                    return _mm256_cmp_ps(a, b, _CMP_GT_OQ);
+                }
+
+                static reg select(reg m, reg a, reg b) {
+                    return _mm256_blendv_ps(b, a, m);
+                }
+
+                static reg copysign(reg magnitude, reg sign) {
+                    reg mask = _mm256_set1_ps(-0.0f);
+                    return _mm256_or_ps(_mm256_andnot_ps(mask, magnitude), _mm256_and_ps(mask, sign));
+                }
+
+                static f4 dot(reg a, reg b) {
+                    reg m = _mm256_mul_ps(a, b);
+                    return traits<f4, 4>::hsum(_mm_add_ps(
+                            _mm256_castps256_ps128(m), _mm256_extractf128_ps(m, 1)));
+                }
+            };
+#else
+
+            template<>
+            struct traits<f4, 8> : pair_traits<traits<f4, 4>>, layout<f4, 8> { };
+#endif
+
+            template<>
+            struct traits<f8, 2> : layout<f8, 2> {
+                using value_type = f8;
+                using reg = __m128d;
+
+
+                static reg load(const f8 *p) {
+                    return _mm_load_pd(p);
+                }
+
+                static void store(f8 *p, reg v) {
+                    _mm_store_pd(p, v);
+                }
+
+                static reg set1(f8 v) {
+                    return _mm_set1_pd(v);
+                }
+
+                static reg add(reg a, reg b) {
+                    return _mm_add_pd(a, b);
+                }
+
+                static reg sub(reg a, reg b) {
+                    return _mm_sub_pd(a, b);
+                }
+
+                static reg mul(reg a, reg b) {
+                    return _mm_mul_pd(a, b);
+                }
+
+                static reg div(reg a, reg b) {
+                    return _mm_div_pd(a, b);
+                }
+
+                static reg min(reg a, reg b) {
+                    return _mm_min_pd(a, b);
+                }
+
+                static reg max(reg a, reg b) {
+                    return _mm_max_pd(a, b);
+                }
+
+                static reg neg(reg a) {
+                    return _mm_xor_pd(a, _mm_set1_pd(-0.0));
+                }
+
+                static reg abs(reg a) {
+                    return _mm_andnot_pd(_mm_set1_pd(-0.0), a);
+                }
+
+                static reg sqrt(reg a) {
+                    return _mm_sqrt_pd(a);
+                }
+
+                template<size_t i0, size_t i1>
+                static reg shuffle(reg a) {
+                    return _mm_shuffle_pd(a, a, i0 | (i1 << 1));
+                }
+
+#if defined(__SSE4_1__)
+
+                static reg floor(reg a) {
+                    return _mm_floor_pd(a);
+                }
+#endif
+
+                static f8 hsum(reg a) {
+                    return _mm_cvtsd_f64(_mm_add_sd(a, _mm_unpackhi_pd(a, a)));
+                }
+
+                static f8 dot(reg a, reg b) {
+                    return hsum(_mm_mul_pd(a, b));
+                }
+            };
+
+#if defined(__AVX__)
+
+            template<>
+            struct traits<f8, 4> : layout<f8, 4> {
+                using value_type = f8;
+                using reg = __m256d;
+
+
+                static reg load(const f8 *p) {
+                    return _mm256_load_pd(p);
+                }
+
+                static void store(f8 *p, reg v) {
+                    _mm256_store_pd(p, v);
+                }
+
+                static reg set1(f8 v) {
+                    return _mm256_set1_pd(v);
+                }
+
+                static reg add(reg a, reg b) {
+                    return _mm256_add_pd(a, b);
+                }
+
+                static reg sub(reg a, reg b) {
+                    return _mm256_sub_pd(a, b);
+                }
+
+                static reg mul(reg a, reg b) {
+                    return _mm256_mul_pd(a, b);
+                }
+
+                static reg div(reg a, reg b) {
+                    return _mm256_div_pd(a, b);
+                }
+
+                static reg min(reg a, reg b) {
+                    return _mm256_min_pd(a, b);
+                }
+
+                static reg max(reg a, reg b) {
+                    return _mm256_max_pd(a, b);
+                }
+
+                static reg neg(reg a) {
+                    return _mm256_xor_pd(a, _mm256_set1_pd(-0.0));
+                }
+
+                static reg abs(reg a) {
+                    return _mm256_andnot_pd(_mm256_set1_pd(-0.0), a);
+                }
+
+                static reg sqrt(reg a) {
+                    return _mm256_sqrt_pd(a);
+                }
+
+#if defined(__AVX2__)
+
+                template<size_t i0, size_t i1, size_t i2, size_t i3>
+                static reg shuffle(reg a) {
+                    return _mm256_permute4x64_pd(a, _MM_SHUFFLE(i3, i2, i1, i0));
+                }
+#endif
+
+                static reg floor(reg a) {
+                    return _mm256_floor_pd(a);
+                }
+
+                static f8 dot(reg a, reg b) {
+                    reg m = _mm256_mul_pd(a, b);
+                    return traits<f8, 2>::hsum(_mm_add_pd(
+                            _mm256_castpd256_pd128(m), _mm256_extractf128_pd(m, 1)));
+                }
+            };
+#else
+
+            template<>
+            struct traits<f8, 4> : pair_traits<traits<f8, 2>>, layout<f8, 4> { };
+#endif
+
+            template<>
+            struct traits<s4, 4> : layout<s4, 4> {
+                using value_type = s4;
+                using reg = __m128i;
+
+
+                static reg load(const s4 *p) {
+                    return _mm_load_si128(reinterpret_cast<const __m128i *>(p));
+                }
+
+                static void store(s4 *p, reg v) {
+                    _mm_store_si128(reinterpret_cast<__m128i *>(p), v);
+                }
+
+                static reg set1(s4 v) {
+                    return _mm_set1_epi32(v);
+                }
+
+                static reg add(reg a, reg b) {
+                    return _mm_add_epi32(a, b);
+                }
+
+                static reg sub(reg a, reg b) {
+                    return _mm_sub_epi32(a, b);
+                }
+
+                static reg band(reg a, reg b) {
+                    return _mm_and_si128(a, b);
+                }
+
+                static reg bor(reg a, reg b) {
+                    return _mm_or_si128(a, b);
+                }
+
+                static reg bxor(reg a, reg b) {
+                    return _mm_xor_si128(a, b);
+                }
+
+                static reg neg(reg a) {
+                    return _mm_sub_epi32(_mm_setzero_si128(), a);
+                }
+
+                template<size_t i0, size_t i1, size_t i2, size_t i3>
+                static reg shuffle(reg a) {
+                    return _mm_shuffle_epi32(a, _MM_SHUFFLE(i3, i2, i1, i0));
+                }
+
+                static s4 hsum(reg a) {
+                    a = _mm_add_epi32(a, _mm_shuffle_epi32(a, _MM_SHUFFLE(1, 0, 3, 2)));
+                    a = _mm_add_epi32(a, _mm_shuffle_epi32(a, _MM_SHUFFLE(2, 3, 0, 1)));
+                    return _mm_cvtsi128_si32(a);
+                }
+
+#if defined(__SSSE3__)
+
+                static reg abs(reg a) {
+                    return _mm_abs_epi32(a);
+                }
+#endif
+#if defined(__SSE4_1__)
+
+                static reg mul(reg a, reg b) {
+                    return _mm_mullo_epi32(a, b);
+                }
+
+                static reg min(reg a, reg b) {
+                    return _mm_min_epi32(a, b);
+                }
+
+                static reg max(reg a, reg b) {
+                    return _mm_max_epi32(a, b);
+                }
+
+                static s4 dot(reg a, reg b) {
+                    return hsum(_mm_mullo_epi32(a, b));
+                }
+#endif
+            };
+
+#if defined(__AVX2__)
+
+            template<>
+            struct traits<s4, 8> : layout<s4, 8> {
+                using value_type = s4;
+                using reg = __m256i;
+
+
+                static reg load(const s4 *p) {
+                    return _mm256_load_si256(reinterpret_cast<const __m256i *>(p));
+                }
+
+                static void store(s4 *p, reg v) {
+                    _mm256_store_si256(reinterpret_cast<__m256i *>(p), v);
+                }
+
+                static reg set1(s4 v) {
+                    return _mm256_set1_epi32(v);
+                }
+
+                static reg add(reg a, reg b) {
+                    return _mm256_add_epi32(a, b);
+                }
+
+                static reg sub(reg a, reg b) {
+                    return _mm256_sub_epi32(a, b);
+                }
+
+                static reg mul(reg a, reg b) {
+                    return _mm256_mullo_epi32(a, b);
+                }
+
+                static reg band(reg a, reg b) {
+                    return _mm256_and_si256(a, b);
+                }
+
+                static reg bor(reg a, reg b) {
+                    return _mm256_or_si256(a, b);
+                }
+
+                static reg bxor(reg a, reg b) {
+                    return _mm256_xor_si256(a, b);
+                }
+
+                static reg min(reg a, reg b) {
+                    return _mm256_min_epi32(a, b);
+                }
+
+                static reg max(reg a, reg b) {
+                    return _mm256_max_epi32(a, b);
+                }
+
+                static reg neg(reg a) {
+                    return _mm256_sub_epi32(_mm256_setzero_si256(), a);
+                }
+
+                static reg abs(reg a) {
+                    return _mm256_abs_epi32(a);
+                }
+
+                template<size_t i0, size_t i1, size_t i2, size_t i3,
+                        size_t i4, size_t i5, size_t i6, size_t i7>
+                static reg shuffle(reg a) {
+                    return _mm256_permutevar8x32_epi32(a, _mm256_setr_epi32(i0, i1, i2, i3, i4, i5, i6, i7));
+                }
+
+                static s4 dot(reg a, reg b) {
+                    reg m = _mm256_mullo_epi32(a, b);
+                    return traits<s4, 4>::hsum(_mm_add_epi32(
+                            _mm256_castsi256_si128(m), _mm256_extracti128_si256(m, 1)));
+                }
+            };
+#else
+
+            template<>
+            struct traits<s4, 8> : pair_traits<traits<s4, 4>>, layout<s4, 8> { };
+#endif
+
+#endif // __SSE2__
+
+#define SIMD_UNARY_DETECTOR(name)                                                \
+            template<typename Tr, typename = void>                               \
+            struct has_##name : std::false_type { };                             \
+            template<typename Tr>                                                \
+            struct has_##name<Tr, decltype(void(Tr::name(                    \
+                    Tr::set1(std::declval<typename Tr::value_type>()))))>        \
+                    : std::true_type { };
+
+#define SIMD_BINARY_DETECTOR(name)                                               \
+            template<typename Tr, typename = void>                               \
+            struct has_##name : std::false_type { };                             \
+            template<typename Tr>                                                \
+            struct has_##name<Tr, decltype(void(Tr::name(                    \
+                    Tr::set1(std::declval<typename Tr::value_type>()),           \
+                    Tr::set1(std::declval<typename Tr::value_type>()))))>        \
+                    : std::true_type { };
+
+            SIMD_BINARY_DETECTOR(add)
+
+            SIMD_BINARY_DETECTOR(sub)
+
+            SIMD_BINARY_DETECTOR(mul)
+
+            SIMD_BINARY_DETECTOR(div)
+
+            SIMD_BINARY_DETECTOR(band)
+
+            SIMD_BINARY_DETECTOR(bor)
+
+            SIMD_BINARY_DETECTOR(bxor)
+
+            SIMD_BINARY_DETECTOR(min)
+
+            SIMD_BINARY_DETECTOR(max)
+
+            SIMD_BINARY_DETECTOR(dot)
+
+            SIMD_UNARY_DETECTOR(neg)
+
+            SIMD_UNARY_DETECTOR(abs)
+
+            SIMD_UNARY_DETECTOR(sqrt)
+
+            SIMD_UNARY_DETECTOR(floor)
+
+            SIMD_UNARY_DETECTOR(round)
+
+            SIMD_UNARY_DETECTOR(rsqrt)
+
+            SIMD_BINARY_DETECTOR(greater)
+
+            SIMD_BINARY_DETECTOR(copysign)
+
+#undef SIMD_UNARY_DETECTOR
+#undef SIMD_BINARY_DETECTOR
+
+            // Операции без SIMD-реализации всегда выполняются скалярно
+            template<typename Tr, typename = void>
+            struct has_none : std::false_type { };
+
+            template<typename Tr, typename Seq, typename = void>
+            struct has_shuffle_sequence : std::false_type { };
+            template<typename Tr, size_t... index>
+            struct has_shuffle_sequence<Tr, std::index_sequence<index...>,
+                    decltype(void(Tr::template shuffle<index...>(
+                            Tr::set1(std::declval<typename Tr::value_type>()))))>
+                    : std::true_type { };
+
+            template<typename Tr>
+            using has_shuffle = has_shuffle_sequence<Tr, std::make_index_sequence<Tr::storage_size>>;
+
+            /*
+             * Операция has над Vector<T, size> выполняется SIMD-ветвью, если
+             * traits<T, size> её реализует и типы всех аргументов совпадают
+             * с типом результата.
+             */
+            template<template<typename, typename> class has,
+                    typename T, size_t size, typename... Tp>
+            constexpr bool enabled = has<traits<T, size>, void>::value
+                                     && (std::is_same_v<T, Tp> && ...);
+
+            /*
+             * Перестановка Vector<T, size> в Vector<T, out_size> выполняется
+             * одной инструкцией, если оба вектора хранятся в одном регистре.
+             */
+            template<typename T, size_t size, size_t out_size>
+            constexpr bool shuffle_enabled = has_shuffle<traits<T, size>>::value
+                                             && has_shuffle<traits<T, out_size>>::value
+                                             && traits<T, size>::storage_size
+                                                == traits<T, out_size>::storage_size;
+
+        } // namespace simd
+
+    } // namespace detail
+
+} // namespace JIO
+
+#endif /* VECTOR_SIMD_HPP */